@@ -0,0 +1,321 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <csignal>
+#include <cstdlib>
+#include <functional>
+#include <iostream>
+#include <new>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include "include/forti_api.hpp"
+#include "mock_fortigate.hpp"
+
+/*
+ * End-to-end load benchmark: runs every accessor against a MockFortiGate (forked into its own process so its work
+ * never shows up in the client's numbers) and reports throughput, latency percentiles, C++ heap allocations per call
+ * and peak RSS.
+ *
+ *     forti-api-load --calls 500 --concurrency 8 --latency-ms 2
+ *     forti-api-load --target 127.0.0.1:8443 --ca /tmp/mock-ca.pem --only policies
+ *     forti-api-load --target 127.0.0.1:8443 --ca /tmp/h2-ca.pem --http both
+ *
+ *     forti-api-load --compression both --link-kib-s 1024 --latency-ms 20
+ *
+ * `--http both` runs every accessor over HTTP/1.1 and then over multiplexed HTTP/2 and reports the TLS connections
+ * each needed.  The mock only speaks HTTP/1.1 (HTTP/2 falls back), so point --target at an HTTP/2 front end, e.g.
+ * `nghttpx -f127.0.0.1,8443 -b'127.0.0.1,<mock port>;;tls' -k key.pem cert.pem`, or a real FortiGate.
+ *
+ * `--compression both` runs every accessor with plain bodies and then with gzip-encoded responses and request bodies
+ * (Compression::request_threshold = 1 KiB); the "KiB in/out" columns are the HTTP body bytes that crossed the wire per
+ * call, as curl reports them before decoding.
+ *
+ * Allocations are counted through the global operator new, so they cover the client's own containers and JSON
+ * decoding but not curl's or OpenSSL's internal mallocs.
+ */
+
+static std::atomic<unsigned long long> allocations{0}, allocated_bytes{0};
+
+void* operator new(std::size_t size) {
+    allocations.fetch_add(1, std::memory_order_relaxed);
+    allocated_bytes.fetch_add(size, std::memory_order_relaxed);
+    if (void* p = std::malloc(size ? size : 1)) return p;
+    throw std::bad_alloc();
+}
+
+// kept out of line so GCC doesn't flag the inlined free() as mismatched with operator new
+[[gnu::noinline]] void operator delete(void* p) noexcept { std::free(p); }
+[[gnu::noinline]] void operator delete(void* p, std::size_t) noexcept { std::free(p); }
+
+struct Options {
+    std::size_t calls = 200, concurrency = 8;
+    std::string target, ca_cert_path = "/tmp/forti-api-load-ca.pem", only, metrics, http = "1.1",
+                compression = "off";
+    MockFortiGate::Settings mock;
+};
+
+struct Scenario {
+    std::string name;
+    std::function<void()> call;
+};
+
+struct Result {
+    std::size_t calls{}, errors{};
+    unsigned long long http_requests{}, connections{}, allocations{}, allocated_bytes{}, wire_in{}, wire_out{};
+    double seconds{}, p50_ms{}, p99_ms{}, max_ms{};
+    long peak_rss_kib{};
+};
+
+static long peak_rss_kib() {
+    rusage usage{};
+    getrusage(RUSAGE_SELF, &usage);
+    return usage.ru_maxrss;
+}
+
+static double percentile(std::vector<double>& samples, double p) {
+    if (samples.empty()) return 0;
+    auto index = std::min(samples.size() - 1, static_cast<std::size_t>(p * static_cast<double>(samples.size())));
+    std::nth_element(samples.begin(), samples.begin() + static_cast<std::ptrdiff_t>(index), samples.end());
+    return samples[index];
+}
+
+// body bytes on the wire so far, summed over every metrics series
+static std::pair<unsigned long long, unsigned long long> wire_bytes() {
+    std::pair<unsigned long long, unsigned long long> total;
+    for (const auto& series : Metrics::json()) {
+        total.first += series["bytes_in"].get<unsigned long long>();
+        total.second += series["bytes_out"].get<unsigned long long>();
+    }
+    return total;
+}
+
+static Result run(const Scenario& scenario, const Options& options) {
+    using Clock = std::chrono::steady_clock;
+
+    auto wire_before = wire_bytes();
+
+    std::vector<std::vector<double>> latencies(options.concurrency);
+    std::atomic<std::size_t> next{0}, errors{0};
+    auto pool_before = ConnectionPool::stats();
+    auto allocations_before = allocations.load();
+    auto bytes_before = allocated_bytes.load();
+    auto start = Clock::now();
+
+    std::vector<std::thread> workers;
+    for (std::size_t worker = 0; worker < options.concurrency; ++worker) {
+        workers.emplace_back([&, worker] {
+            latencies[worker].reserve(options.calls / options.concurrency + 1);
+            while (next.fetch_add(1) < options.calls) {
+                auto begin = Clock::now();
+                try {
+                    scenario.call();
+                } catch (const std::exception& e) {
+                    if (errors.fetch_add(1) == 0) std::cerr << "[WARNING] " << scenario.name << ": " << e.what() << "\n";
+                }
+                latencies[worker].push_back(std::chrono::duration<double, std::milli>(Clock::now() - begin).count());
+            }
+        });
+    }
+    for (auto& worker : workers) worker.join();
+
+    Result result;
+    result.seconds = std::chrono::duration<double>(Clock::now() - start).count();
+    result.allocations = allocations.load() - allocations_before;
+    result.allocated_bytes = allocated_bytes.load() - bytes_before;
+    auto pool = ConnectionPool::stats();
+    result.http_requests = pool.requests - pool_before.requests;
+    result.connections = pool.new_connections - pool_before.new_connections;
+    result.calls = options.calls;
+    result.errors = errors.load();
+    result.peak_rss_kib = peak_rss_kib();
+    auto wire_after = wire_bytes();
+    result.wire_in = wire_after.first - wire_before.first;
+    result.wire_out = wire_after.second - wire_before.second;
+
+    std::vector<double> samples;
+    for (auto& worker : latencies) samples.insert(samples.end(), worker.begin(), worker.end());
+    result.p50_ms = percentile(samples, 0.50);
+    result.p99_ms = percentile(samples, 0.99);
+    result.max_ms = samples.empty() ? 0 : *std::max_element(samples.begin(), samples.end());
+    return result;
+}
+
+static std::vector<Scenario> scenarios() {
+    static const CommandsRequest push = [] {
+        std::vector<std::string> entries;
+        for (int i = 0; i < 10000; ++i) entries.push_back(std::format("load-{}.example.com", i));
+        return CommandsRequest(CommandEntry("feed-0", entries));
+    }();
+    static const std::string push_body = nlohmann::json(push).dump();
+
+    return {
+        {"policies.get", [] { FortiGate::Policies::get(); }},
+        {"policies.get<id,name>", [] { FortiGate::Policies::get<&FirewallPolicy::policyid, &FirewallPolicy::name>(); }},
+        {"policies.get(name)", [] { FortiGate::Policies::get("policy-42"); }},
+        {"policies.paged", [] { for (const auto& policy : FortiGate::Policies::paged(100)) (void) policy; }},
+        {"policies.get_async", [] { FortiGate::Policies::get_async().get(); }},
+        {"services.get", [] { FortiGate::Services::get(); }},
+        {"dns_filter.get", [] { DNSFilter::get(); }},
+        {"dns_filter.get(name)", [] { DNSFilter::get("profile-1"); }},
+        {"dns_filter.contains", [] { DNSFilter::contains("profile-1"); }},
+        {"threat_feed.get", [] { ThreatFeed::get(); }},
+        {"threat_feed.for_each_entry", [] { ThreatFeed::for_each_entry("feed-1", [](Entry) {}); }},
+        {"threat_feed.update_feed", [] { ThreatFeed::update_feed(push); }},
+        {"prepared.update_feed", [] {
+            thread_local PreparedRequest request("POST", "/monitor/system/external-resource/dynamic");
+            request.send(push_body);
+        }},
+        {"interfaces.get", [] { FortiAPI::get<InterfacesGeneralResponse>("/monitor/system/available-interfaces"); }},
+    };
+}
+
+static void usage() {
+    std::cerr << "usage: forti-api-load [--calls N] [--concurrency N] [--only SUBSTRING] [--metrics prometheus|json]\n"
+                 "                      [--http 1.1|2|both] [--compression off|on|both]\n"
+                 "                      [--target HOST:PORT --ca PATH] | [--latency-ms MS] [--jitter-ms MS]\n"
+                 "                      [--error-rate P] [--error-status CODE] [--policies N] [--feed-entries N]\n"
+                 "                      [--link-kib-s KIB_PER_SECOND]\n";
+}
+
+static bool parse(int argc, char **argv, Options& options) {
+    for (int i = 1; i < argc; i += 2) {
+        std::string_view flag = argv[i];
+        if (i + 1 >= argc) return false;
+        std::string value = argv[i + 1];
+
+        if (flag == "--calls") options.calls = std::stoul(value);
+        else if (flag == "--concurrency") options.concurrency = std::max<std::size_t>(1, std::stoul(value));
+        else if (flag == "--only") options.only = value;
+        else if (flag == "--metrics") options.metrics = value;
+        else if (flag == "--http" && (value == "1.1" || value == "2" || value == "both")) options.http = value;
+        else if (flag == "--compression" && (value == "off" || value == "on" || value == "both")) options.compression = value;
+        else if (flag == "--target") options.target = value;
+        else if (flag == "--ca") options.ca_cert_path = value;
+        else if (flag == "--latency-ms") options.mock.latency = std::chrono::microseconds(static_cast<long long>(std::stod(value) * 1000));
+        else if (flag == "--jitter-ms") options.mock.jitter = std::chrono::microseconds(static_cast<long long>(std::stod(value) * 1000));
+        else if (flag == "--error-rate") options.mock.error_rate = std::stod(value);
+        else if (flag == "--error-status") options.mock.error_status = std::stoi(value);
+        else if (flag == "--policies") options.mock.policies = std::stoul(value);
+        else if (flag == "--feed-entries") options.mock.feed_entries = std::stoul(value);
+        else if (flag == "--link-kib-s") options.mock.link_kib_per_second = std::stod(value);
+        else return false;
+    }
+    return true;
+}
+
+// forks the mock into a child process and waits for it to report its port
+static pid_t spawn_mock(Options& options) {
+    int ready[2];
+    if (pipe(ready) != 0) throw std::runtime_error("pipe() failed");
+
+    pid_t child = fork();
+    if (child == 0) {
+        close(ready[0]);
+        options.mock.ca_cert_path = options.ca_cert_path;
+        MockFortiGate server(options.mock);
+        unsigned short port = server.start();
+        if (write(ready[1], &port, sizeof(port)) != sizeof(port)) _exit(1);
+        pause();  // until the parent's SIGTERM
+        _exit(0);
+    }
+
+    close(ready[1]);
+    unsigned short port = 0;
+    if (read(ready[0], &port, sizeof(port)) != sizeof(port)) throw std::runtime_error("mock FortiGate failed to start");
+    close(ready[0]);
+    options.target = std::format("127.0.0.1:{}", port);
+    return child;
+}
+
+// one protocol + encoding combination; `label` tells the rows apart when several are run
+struct Mode {
+    bool http2{}, compressed{};
+    std::string label;
+};
+
+static void print_header() {
+    std::cout << std::format("{:<40} {:>7} {:>6} {:>9} {:>9} {:>9} {:>9} {:>6} {:>10} {:>11} {:>10} {:>10} {:>9}\n",
+                             "accessor", "calls", "errors", "calls/s", "p50 ms", "p99 ms", "http req", "conns",
+                             "allocs/op", "KiB/op", "KiB in/op", "KiB out/op", "peak MiB");
+}
+
+// runs every selected scenario in one mode, then prints the requested metrics
+static void run_all(const Options& options, const Mode& mode) {
+    ConnectionPool::http2 = mode.http2;
+    Compression::accept_responses = mode.compressed;
+    Compression::request_threshold = mode.compressed ? 1024 : 0;
+    for (const auto& scenario : scenarios()) {
+        if (!options.only.empty() && scenario.name.find(options.only) == std::string::npos) continue;
+
+        auto result = run(scenario, options);
+        auto name = mode.label.empty() ? scenario.name : std::format("{} [{}]", scenario.name, mode.label);
+        auto per_call = [&](unsigned long long bytes) { return static_cast<double>(bytes) / result.calls / 1024.0; };
+        std::cout << std::format("{:<40} {:>7} {:>6} {:>9.1f} {:>9.2f} {:>9.2f} {:>9} {:>6} {:>10.1f} {:>11.1f} {:>10.1f} "
+                                 "{:>10.1f} {:>9.1f}\n",
+                                 name, result.calls, result.errors, result.calls / result.seconds,
+                                 result.p50_ms, result.p99_ms, result.http_requests, result.connections,
+                                 static_cast<double>(result.allocations) / result.calls,
+                                 per_call(result.allocated_bytes), per_call(result.wire_in), per_call(result.wire_out),
+                                 result.peak_rss_kib / 1024.0);
+    }
+
+    if (options.metrics == "prometheus") std::cout << '\n' << Metrics::prometheus();
+    else if (options.metrics == "json") std::cout << '\n' << Metrics::json().dump(2) << '\n';
+}
+
+int main(int argc, char **argv) {
+    Options options;
+    if (!parse(argc, argv, options)) {
+        usage();
+        return 1;
+    }
+
+    pid_t mock = options.target.empty() ? spawn_mock(options) : 0;
+
+    auto colon = options.target.rfind(':');
+    FortiAuth::set_gateway_ip(options.target.substr(0, colon));
+    FortiAuth::set_admin_https_port(std::stoi(options.target.substr(colon + 1)));
+    FortiAuth::set_ca_cert_path(options.ca_cert_path);
+    FortiAuth::set_ssl_cert_path("");
+    FortiAuth::set_cert_password("");
+    FortiAuth::set_api_key("forti-api-load");
+
+    print_header();
+    std::vector<bool> protocols, encodings;
+    if (options.http != "2") protocols.push_back(false);
+    if (options.http != "1.1") protocols.push_back(true);
+    if (options.compression != "on") encodings.push_back(false);
+    if (options.compression != "off") encodings.push_back(true);
+
+    std::vector<Mode> modes;
+    for (bool http2 : protocols) for (bool compressed : encodings) {
+        std::string label;
+        if (protocols.size() > 1) label = http2 ? "h2" : "h1";
+        if (encodings.size() > 1) label += std::format("{}{}", label.empty() ? "" : " ", compressed ? "gzip" : "plain");
+        modes.push_back({http2, compressed, std::move(label)});
+    }
+
+    if (modes.size() == 1) run_all(options, modes.front());
+    else for (const auto& mode : modes) {
+        // each mode runs in a fresh process: warm pooled connections and TLS sessions would otherwise carry over
+        std::cout.flush();
+        pid_t child = fork();
+        if (child == 0) {
+            run_all(options, mode);
+            std::cout.flush();
+            _exit(0);
+        }
+        waitpid(child, nullptr, 0);
+    }
+
+    if (mock > 0) {
+        kill(mock, SIGTERM);
+        waitpid(mock, nullptr, 0);
+    }
+    return 0;
+}
@@ -0,0 +1,692 @@
+#ifndef FORTI_API_MOCK_FORTIGATE_HPP
+#define FORTI_API_MOCK_FORTIGATE_HPP
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <csignal>
+#include <cstdio>
+#include <format>
+#include <fstream>
+#include <list>
+#include <map>
+#include <mutex>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <openssl/err.h>
+#include <openssl/evp.h>
+#include <openssl/pem.h>
+#include <openssl/ssl.h>
+#include <openssl/x509v3.h>
+#include <nlohmann/json.hpp>
+#include "include/forti_api/compression.hpp"
+#include "include/forti_api/types/dns/filter.h"
+#include "include/forti_api/types/firewall/policies.h"
+#include "include/forti_api/types/firewall/services.h"
+#include "include/forti_api/types/threat_feed/ext_connector.h"
+
+
+/*
+ * Local stand-in for a FortiGate's REST API, for reproducible load and latency measurements.
+ *
+ * Serves HTTPS/1.1 with keep-alive on 127.0.0.1 using a throwaway self-signed certificate (written to `ca_cert_path`
+ * so clients can verify it).  CMDB tables are generated from the forti-api types themselves and support mkey lookups,
+ * start/count paging, `filter=` (==, !=, =@, !@) and `format=` projections, and POST/PUT/DELETE that bump the config
+ * revision.  Every response can be delayed by `latency` (+ uniform `jitter`) and fail with `error_status` at
+ * `error_rate`, and `link_kib_per_second` emulates a thin WAN link by holding every exchange for as long as its bytes
+ * would take to cross it.  Responses of at least `gzip_min_length` bytes are gzip-encoded for clients that accept it, and
+ * gzip/deflate request bodies are decoded (or refused with 415 when `accept_encoded_requests` is off).  The byte
+ * counters in Stats are what crossed the wire, before decoding.
+ */
+class MockFortiGate {
+public:
+    struct Settings {
+        unsigned short port = 0;  // 0 picks a free port
+        std::string ca_cert_path = "mock-fortigate-ca.pem";
+        std::chrono::microseconds latency{0}, jitter{0};
+        double error_rate = 0.0;
+        unsigned int error_status = 503;
+        double link_kib_per_second = 0;  // 0: unlimited
+        std::size_t gzip_min_length = 1024;  // 0 never compresses responses
+        bool accept_encoded_requests = true;
+        std::size_t policies = 500, services = 300, profiles = 20, feeds = 10, feed_entries = 10000, interfaces = 48;
+        unsigned int seed = 1;
+    };
+
+    struct Stats {
+        unsigned long long requests{}, errors{}, connections{}, bytes_in{}, bytes_out{};
+    };
+
+private:
+    struct Table {
+        std::string key;  // mkey attribute
+        std::vector<nlohmann::json> rows;
+    };
+
+    struct Request {
+        std::string method, path, query, body, content_encoding;
+        bool keep_alive = true, accepts_gzip = false;
+    };
+
+    struct Connection {
+        int fd;
+        std::thread worker;
+        bool finished = false;
+    };
+
+    Settings settings;
+    SSL_CTX* context = nullptr;
+    int listener = -1;
+    std::atomic<bool> running{false};
+    std::thread acceptor;
+
+    std::mutex connections_mutex;
+    std::list<Connection> connections;
+
+    std::mutex data_mutex;
+    std::map<std::string, Table, std::less<>> tables;
+    std::map<std::string, std::vector<nlohmann::json>, std::less<>> feed_entries;
+    std::vector<nlohmann::json> interfaces;
+    unsigned long long revision = 1;
+
+    std::mutex random_mutex;
+    std::mt19937 random;
+
+    std::atomic<unsigned long long> requests{0}, errors{0}, accepted{0}, bytes_in{0}, bytes_out{0};
+
+    // ---- certificate ----
+
+    void create_context() {
+        EVP_PKEY* key = EVP_EC_gen("P-256");
+        X509* certificate = X509_new();
+        if (!key || !certificate) throw std::runtime_error("MockFortiGate: unable to create a certificate");
+
+        X509_set_version(certificate, 2);
+        ASN1_INTEGER_set(X509_get_serialNumber(certificate), 1);
+        X509_gmtime_adj(X509_getm_notBefore(certificate), -60);
+        X509_gmtime_adj(X509_getm_notAfter(certificate), 60L * 60 * 24 * 30);
+        X509_set_pubkey(certificate, key);
+
+        X509_NAME* name = X509_get_subject_name(certificate);
+        X509_NAME_add_entry_by_txt(name, "O", MBSTRING_ASC, reinterpret_cast<const unsigned char*>("forti-api mock"), -1, -1, 0);
+        X509_NAME_add_entry_by_txt(name, "CN", MBSTRING_ASC, reinterpret_cast<const unsigned char*>("127.0.0.1"), -1, -1, 0);
+        X509_set_issuer_name(certificate, name);
+
+        X509V3_CTX v3;
+        X509V3_set_ctx_nodb(&v3);
+        X509V3_set_ctx(&v3, certificate, certificate, nullptr, nullptr, 0);
+        for (auto [nid, value] : {std::pair{NID_basic_constraints, "critical,CA:TRUE"},
+                                  std::pair{NID_subject_alt_name, "IP:127.0.0.1,DNS:localhost"}}) {
+            X509_EXTENSION* extension = X509V3_EXT_conf_nid(nullptr, &v3, nid, value);
+            X509_add_ext(certificate, extension, -1);
+            X509_EXTENSION_free(extension);
+        }
+        X509_sign(certificate, key, EVP_sha256());
+
+        FILE* out = std::fopen(settings.ca_cert_path.c_str(), "w");
+        if (!out) throw std::runtime_error("MockFortiGate: unable to write " + settings.ca_cert_path);
+        PEM_write_X509(out, certificate);
+        std::fclose(out);
+
+        context = SSL_CTX_new(TLS_server_method());
+        SSL_CTX_use_certificate(context, certificate);
+        SSL_CTX_use_PrivateKey(context, key);
+        X509_free(certificate);
+        EVP_PKEY_free(key);
+        if (!SSL_CTX_check_private_key(context)) throw std::runtime_error("MockFortiGate: TLS setup failed");
+    }
+
+    // ---- data ----
+
+    static nlohmann::json with_origin(nlohmann::json row, const nlohmann::json& key) {
+        row["q_origin_key"] = key;
+        return row;
+    }
+
+    void generate() {
+        const std::vector<std::string> ports = {"port1", "port2", "port3", "wan1", "wan2", "internal"};
+
+        auto& policies = tables["/cmdb/firewall/policy"];
+        policies.key = "policyid";
+        for (std::size_t i = 1; i <= settings.policies; ++i) {
+            FirewallPolicy policy;
+            policy.policyid = i;
+            policy.uuid_idx = 1000 + i;
+            policy.name = std::format("policy-{}", i);
+            policy.status = i % 7 ? "enable" : "disable";
+            policy.action = i % 3 ? "accept" : "deny";
+            policy.srcintf = {{{ports[i % ports.size()], ports[i % ports.size()]}}};
+            policy.dstintf = {{{"wan1", "wan1"}}};
+            policy.srcaddr = {{{"all", "all"}}};
+            policy.dstaddr = {{{std::format("net-{}", i % 32), std::format("net-{}", i % 32)}}};
+            policy.service = {{{"HTTPS", "HTTPS"}}, {{"DNS", "DNS"}}};
+            policy.ssl_ssh_profile = "certificate-inspection";
+            policy.av_profile = "default";
+            policy.webfilter_profile = "default";
+            policy.dnsfilter_profile = std::format("profile-{}", i % std::max<std::size_t>(settings.profiles, 1));
+            policy.nat = "enable";
+            policy.inbound = policy.outbound = policy.natinbound = policy.natoutbound = "disable";
+            policy.comments = std::format("generated policy {}", i);
+            policies.rows.push_back(with_origin(policy, i));
+        }
+
+        auto& services = tables["/cmdb/firewall.service/custom"];
+        services.key = "name";
+        for (std::size_t i = 0; i < settings.services; ++i) {
+            FirewallService service(std::format("svc-{}", i));
+            service.protocol = "TCP/UDP/SCTP";
+            service.tcp_portrange = std::format("{}", 1024 + i);
+            service.category = i % 2 ? "Web Access" : "General";
+            service.uuid_idx = 2000 + i;
+            services.rows.push_back(with_origin(service, service.name));
+        }
+
+        auto& categories = tables["/cmdb/firewall.service/category"];
+        categories.key = "name";
+        for (const auto* category : {"General", "Web Access", "File Access", "Email", "Network Services", "Remote Access"})
+            categories.rows.push_back(with_origin(ServiceCategory(category), category));
+
+        auto& schedules = tables["/cmdb/firewall.schedule/recurring"];
+        schedules.key = "name";
+        for (const auto* schedule : {"always", "none", "weekdays", "weekends"})
+            schedules.rows.push_back({{"name", schedule}, {"q_origin_key", schedule}, {"start", "00:00"},
+                                      {"end", "00:00"}, {"day", "sunday monday tuesday wednesday thursday friday saturday"},
+                                      {"color", 0}, {"fabric-object", "disable"}});
+
+        auto& profiles = tables["/cmdb/dnsfilter/profile"];
+        profiles.key = "name";
+        for (std::size_t i = 0; i < settings.profiles; ++i) {
+            DNSProfile profile(std::format("profile-{}", i));
+            for (unsigned int category = 1; category <= 90; ++category) {
+                if (category % 5 == 0) profile.block_category(category);
+                else if (category % 3 == 0) profile.monitor_category(category);
+            }
+            auto row = with_origin(profile, profile.name);
+            std::size_t id = 0;
+            for (auto& filter : row["ftgd-dns"]["filters"]) filter["id"] = ++id;
+            profiles.rows.push_back(std::move(row));
+        }
+
+        auto& resources = tables["/cmdb/system/external-resource"];
+        resources.key = "name";
+        for (std::size_t i = 0; i < settings.feeds; ++i) {
+            PushThreatFeed feed(std::format("feed-{}", i), 192 + i % 30);
+            resources.rows.push_back(with_origin(feed, feed.name));
+
+            auto& entries = feed_entries[feed.name];
+            for (std::size_t entry = 0; entry < settings.feed_entries; ++entry)
+                entries.push_back({{"entry", std::format("host-{}.feed-{}.example.com", entry, i)}, {"valid", "true"}});
+        }
+
+        auto& users = tables["/cmdb/system/api-user"];
+        users.key = "name";
+        users.rows.push_back({{"name", "forti-api"}, {"q_origin_key", "forti-api"}, {"accprofile", "super_admin"},
+                              {"vdom", {{{"name", "root"}, {"q_origin_key", "root"}}}},
+                              {"trusthost", {{{"id", 1}, {"q_origin_key", 1}, {"type", "ipv4-trusthost"},
+                                              {"ipv4-trusthost", "10.0.0.0 255.0.0.0"}}}}});
+
+        const std::vector<std::string> types = {"physical", "physical", "tunnel", "hard-switch-vlan", "aggregate"};
+        for (std::size_t i = 0; i < settings.interfaces; ++i) {
+            auto type = types[i % types.size()];
+            auto name = i < 2 ? std::format("wan{}", i + 1) : std::format("{}{}", type == "physical" ? "port" : type, i);
+            interfaces.push_back({{"name", name}, {"type", type}, {"vdom", "root"}, {"status", "up"},
+                                  {"real_interface_name", name}, {"is_physical", type == "physical"},
+                                  {"is_used", true}, {"valid_in_policy", true}, {"is_routable", true},
+                                  {"link", "up"}, {"speed", 1000}, {"duplex", "full"},
+                                  {"mac_address", std::format("00:09:0f:09:{:02x}:{:02x}", i / 256, i % 256)},
+                                  {"ipv4_addresses", {{{"ip", std::format("10.{}.0.1", i)}, {"netmask", "255.255.255.0"},
+                                                        {"cidr_netmask", 24}}}},
+                                  {"members", nlohmann::json::array()}});
+        }
+        interfaces.push_back({{"name", "virtual-wan-link"}, {"type", "sdwan"}, {"vdom", "root"}, {"status", "up"},
+                              {"link", "up"}, {"icon", "sdwan"}, {"is_sdwan_zone", true}, {"valid_in_policy", true},
+                              {"members", {"wan1", "wan2"}}});
+    }
+
+    // ---- HTTP ----
+
+    static std::string decode(std::string_view value) {
+        std::string out;
+        for (std::size_t i = 0; i < value.size(); ++i) {
+            if (value[i] == '%' && i + 2 < value.size()) {
+                out.push_back(static_cast<char>(std::stoi(std::string(value.substr(i + 1, 2)), nullptr, 16)));
+                i += 2;
+            } else out.push_back(value[i] == '+' ? ' ' : value[i]);
+        }
+        return out;
+    }
+
+    static std::vector<std::pair<std::string, std::string>> parameters(std::string_view query) {
+        std::vector<std::pair<std::string, std::string>> out;
+        for (std::size_t pos = 0; pos <= query.size() && !query.empty();) {
+            auto next = std::min(query.find('&', pos), query.size());
+            auto param = query.substr(pos, next - pos);
+            auto eq = param.find('=');
+            if (!param.empty())
+                out.emplace_back(std::string(param.substr(0, eq)),
+                                 eq == std::string_view::npos ? "" : decode(param.substr(eq + 1)));
+            pos = next + 1;
+        }
+        return out;
+    }
+
+    static std::string scalar(const nlohmann::json& value) {
+        if (value.is_string()) return value.get<std::string>();
+        if (value.is_array()) {  // member lists: match against any member name
+            std::string names;
+            for (const auto& item : value) names += (item.is_object() ? item.value("name", "") : scalar(item)) + ' ';
+            return names;
+        }
+        return value.dump();
+    }
+
+    // FortiOS filter semantics: one `filter=` parameter is an OR of comma separated terms, several are ANDed
+    static bool matches(const nlohmann::json& row, const std::string& filter) {
+        for (std::size_t pos = 0; pos <= filter.size();) {
+            auto next = std::min(filter.find(',', pos), filter.size());
+            std::string_view term(filter.data() + pos, next - pos);
+            pos = next + 1;
+
+            for (std::string_view op : {"==", "!=", "=@", "!@", "<=", ">=", "<", ">"}) {
+                auto at = term.find(op);
+                if (at == std::string_view::npos) continue;
+                auto field = row.find(std::string(term.substr(0, at)));
+                auto actual = field == row.end() ? std::string() : scalar(*field);
+                auto expected = std::string(term.substr(at + op.size()));
+                bool numeric = field != row.end() && field->is_number();
+
+                bool hit = op == "==" ? actual == expected
+                         : op == "!=" ? actual != expected
+                         : op == "=@" ? actual.find(expected) != std::string::npos
+                         : op == "!@" ? actual.find(expected) == std::string::npos
+                         : numeric ? (op == "<=" ? std::stod(actual) <= std::stod(expected)
+                                    : op == ">=" ? std::stod(actual) >= std::stod(expected)
+                                    : op == "<" ? std::stod(actual) < std::stod(expected)
+                                    : std::stod(actual) > std::stod(expected))
+                         : false;
+                if (hit) return true;
+                break;
+            }
+        }
+        return false;
+    }
+
+    static nlohmann::json project(const nlohmann::json& row, const std::string& format) {
+        nlohmann::json out = nlohmann::json::object();
+        for (std::size_t pos = 0; pos <= format.size();) {
+            auto next = std::min(format.find('|', pos), format.size());
+            auto field = format.substr(pos, next - pos);
+            if (auto it = row.find(field); it != row.end()) out[field] = *it;
+            pos = next + 1;
+        }
+        if (auto it = row.find("q_origin_key"); it != row.end()) out["q_origin_key"] = *it;
+        return out;
+    }
+
+    nlohmann::json envelope(const Request& request, unsigned int status, const std::string& name) const {
+        return {{"http_method", request.method}, {"revision", std::to_string(revision)}, {"vdom", "root"},
+                {"path", request.path}, {"name", name}, {"status", status < 400 ? "success" : "error"},
+                {"http_status", status}, {"serial", "FGVM00MOCK000001"}, {"version", "v7.4.4"}, {"build", 2662}};
+    }
+
+    std::pair<unsigned int, nlohmann::json> list(const Request& request, std::vector<nlohmann::json> rows) const {
+        std::size_t start = 0, count = rows.size();
+        std::string format;
+        for (const auto& [key, value] : parameters(request.query)) {
+            if (key == "filter") std::erase_if(rows, [&](const nlohmann::json& row) { return !matches(row, value); });
+            else if (key == "start") start = std::stoul(value);
+            else if (key == "count") count = std::stoul(value);
+            else if (key == "format") format = value;
+        }
+
+        auto body = envelope(request, 200, "");
+        auto first = std::min(start, rows.size());
+        auto last = std::min(rows.size(), first + count);
+        nlohmann::json results = nlohmann::json::array();
+        for (auto i = first; i < last; ++i) results.push_back(format.empty() ? std::move(rows[i]) : project(rows[i], format));
+
+        body["size"] = rows.size();
+        body["matched_count"] = rows.size();
+        body["next_idx"] = last == 0 ? 0 : last - 1;
+        body["results"] = std::move(results);
+        return {200, std::move(body)};
+    }
+
+    std::pair<unsigned int, nlohmann::json> route(const Request& request) {
+        std::lock_guard lock(data_mutex);
+        std::string_view path = request.path;
+        if (!path.starts_with("/api/v2")) return {404, envelope(request, 404, "")};
+        path.remove_prefix(7);
+
+        if (path == "/monitor/system/available-interfaces") {
+            auto rows = interfaces;
+            for (const auto& [key, value] : parameters(request.query))
+                if (key == "mkey") std::erase_if(rows, [&](const nlohmann::json& row) { return row["name"] != value; });
+            return list(request, std::move(rows));
+        }
+
+        if (path.starts_with("/monitor/system/external-resource/dynamic")) {
+            if (request.method != "POST") return {405, envelope(request, 405, "")};
+            auto commands = nlohmann::json::parse(request.body.empty() ? "{}" : request.body);
+            for (const auto& command : commands.value("commands", nlohmann::json::array())) {
+                auto& entries = feed_entries[command.value("name", "")];
+                auto action = command.value("command", "snapshot");
+                if (action == "snapshot") entries.clear();
+                for (const auto& entry : command.value("entries", nlohmann::json::array())) {
+                    if (action == "remove") std::erase_if(entries, [&](const nlohmann::json& e) { return e["entry"] == entry; });
+                    else entries.push_back({{"entry", entry}, {"valid", "true"}});
+                }
+            }
+            return {200, envelope(request, 200, "")};
+        }
+
+        if (path.starts_with("/cmdb/system/external-resource/entry-list")) {
+            std::string feed;
+            for (const auto& [key, value] : parameters(request.query)) if (key == "mkey") feed = value;
+            std::erase(feed, '/');
+            auto found = feed_entries.find(feed);
+            if (found == feed_entries.end()) return {404, envelope(request, 404, feed)};
+
+            auto body = envelope(request, 200, feed);
+            body["results"] = {{"status", "enable"}, {"resource_file_status", "valid"},
+                               {"last_content_update_time", 1760000000}, {"entries", found->second}};
+            return {200, std::move(body)};
+        }
+
+        // longest table prefix, anything after it is the mkey
+        auto table = tables.end();
+        for (auto it = tables.begin(); it != tables.end(); ++it)
+            if (path.starts_with(it->first) && (path.size() == it->first.size() || path[it->first.size()] == '/'))
+                table = it;
+        if (table == tables.end()) return {404, envelope(request, 404, "")};
+
+        std::string mkey = decode(path.size() > table->first.size() ? path.substr(table->first.size() + 1) : "");
+        auto& rows = table->second.rows;
+        auto row = std::find_if(rows.begin(), rows.end(), [&](const nlohmann::json& r) {
+            return !mkey.empty() && scalar(r[table->second.key]) == mkey;
+        });
+
+        if (request.method == "GET") {
+            if (mkey.empty()) return list(request, rows);
+            if (row == rows.end()) return {404, envelope(request, 404, mkey)};
+            return list(request, {*row});
+        }
+
+        auto payload = request.body.empty() ? nlohmann::json::object() : nlohmann::json::parse(request.body);
+        if (request.method == "POST" && mkey.empty()) {
+            if (!payload.contains(table->second.key)) payload[table->second.key] = rows.size() + 1;
+            payload["q_origin_key"] = payload[table->second.key];
+            rows.push_back(std::move(payload));
+        } else if (row == rows.end()) return {404, envelope(request, 404, mkey)};
+        else if (request.method == "PUT" || request.method == "POST") row->merge_patch(payload);
+        else if (request.method == "DELETE") rows.erase(row);
+        else return {405, envelope(request, 405, mkey)};
+
+        ++revision;
+        auto body = envelope(request, 200, mkey);
+        body["mkey"] = mkey;
+        return {200, std::move(body)};
+    }
+
+    bool inject_error() {
+        if (settings.error_rate <= 0) return false;
+        std::lock_guard lock(random_mutex);
+        return std::uniform_real_distribution<double>(0, 1)(random) < settings.error_rate;
+    }
+
+    void delay() {
+        auto wait = settings.latency;
+        if (settings.jitter.count() > 0) {
+            std::lock_guard lock(random_mutex);
+            wait += std::chrono::microseconds(std::uniform_int_distribution<long long>(0, settings.jitter.count())(random));
+        }
+        if (wait.count() > 0) std::this_thread::sleep_for(wait);
+    }
+
+    std::string respond(Request& request) {
+        ++requests;
+        delay();
+
+        unsigned int status;
+        nlohmann::json body;
+        if (!request.content_encoding.empty() && !settings.accept_encoded_requests) {
+            status = 415;
+            std::lock_guard lock(data_mutex);
+            body = envelope(request, status, "");
+        } else if (inject_error()) {
+            ++errors;
+            status = settings.error_status;
+            std::lock_guard lock(data_mutex);
+            body = envelope(request, status, "");
+        } else {
+            try {
+                if (!request.content_encoding.empty()) request.body = Compression::inflate(request.body);
+                std::tie(status, body) = route(request);
+            } catch (const std::exception& e) {
+                status = 400;
+                body = {{"status", "error"}, {"http_status", 400}, {"error", e.what()}};
+            }
+        }
+
+        auto payload = body.dump();
+        bool gzip = request.accepts_gzip && settings.gzip_min_length > 0 && payload.size() >= settings.gzip_min_length;
+        if (gzip) payload = Compression::gzip(payload);
+        auto head = std::format("HTTP/1.1 {} {}\r\nContent-Type: application/json\r\nContent-Length: {}\r\n{}{}{}\r\n",
+                                status, status < 400 ? "OK" : "Error", payload.size(),
+                                gzip ? "Content-Encoding: gzip\r\n" : "",
+                                status == 429 || status == 503 ? "Retry-After: 1\r\n" : "",
+                                request.keep_alive ? "" : "Connection: close\r\n");
+        return head + payload;
+    }
+
+    // ---- connection handling ----
+
+    class Reader {
+        SSL* ssl;
+        std::string buffer;
+        std::size_t offset = 0;
+
+        bool fill() {
+            char chunk[16384];
+            int n = SSL_read(ssl, chunk, sizeof(chunk));
+            if (n <= 0) return false;
+            if (offset > 0 && offset == buffer.size()) {
+                buffer.clear();
+                offset = 0;
+            }
+            buffer.append(chunk, n);
+            return true;
+        }
+
+    public:
+        explicit Reader(SSL* ssl) : ssl(ssl) {}
+
+        bool line(std::string& out) {
+            std::size_t end;
+            while ((end = buffer.find("\r\n", offset)) == std::string::npos) if (!fill()) return false;
+            out.assign(buffer, offset, end - offset);
+            offset = end + 2;
+            return true;
+        }
+
+        bool bytes(std::size_t count, std::string& out) {
+            while (buffer.size() - offset < count) if (!fill()) return false;
+            out.append(buffer, offset, count);
+            offset += count;
+            return true;
+        }
+    };
+
+    static bool read_request(Reader& reader, Request& request, std::size_t& size) {
+        std::string line;
+        if (!reader.line(line)) return false;
+
+        auto first = line.find(' '), second = line.rfind(' ');
+        if (first == std::string::npos || second == first) return false;
+        request.method = line.substr(0, first);
+        auto target = line.substr(first + 1, second - first - 1);
+        auto question = target.find('?');
+        request.path = target.substr(0, question);
+        request.query = question == std::string::npos ? "" : target.substr(question + 1);
+        request.keep_alive = line.ends_with("HTTP/1.1");
+        request.body.clear();
+        request.content_encoding.clear();
+        request.accepts_gzip = false;
+        size = line.size();
+
+        std::size_t length = 0;
+        bool chunked = false;
+        while (reader.line(line) && !line.empty()) {
+            size += line.size();
+            auto colon = line.find(':');
+            if (colon == std::string::npos) continue;
+            std::string name = line.substr(0, colon), value = line.substr(colon + 1);
+            std::transform(name.begin(), name.end(), name.begin(), [](unsigned char c) { return std::tolower(c); });
+            value.erase(0, value.find_first_not_of(' '));
+
+            if (name == "content-length") length = std::stoul(value);
+            else if (name == "transfer-encoding") chunked = value.find("chunked") != std::string::npos;
+            else if (name == "connection") request.keep_alive = value != "close";
+            else if (name == "content-encoding" && value != "identity") request.content_encoding = value;
+            else if (name == "accept-encoding") request.accepts_gzip = value.find("gzip") != std::string::npos;
+        }
+
+        if (chunked) {
+            while (reader.line(line)) {
+                auto chunk = std::stoul(line, nullptr, 16);
+                if (chunk == 0) {
+                    reader.line(line);
+                    break;
+                }
+                if (!reader.bytes(chunk, request.body) || !reader.line(line)) return false;
+            }
+        } else if (length > 0 && !reader.bytes(length, request.body)) return false;
+
+        size += request.body.size();
+        return true;
+    }
+
+    void serve(Connection& connection) {
+        int fd = connection.fd;
+        SSL* ssl = SSL_new(context);
+        SSL_set_fd(ssl, fd);
+
+        if (SSL_accept(ssl) == 1) {
+            Reader reader(ssl);
+            Request request;
+            std::size_t size = 0;
+            while (running && read_request(reader, request, size)) {
+                bytes_in += size;
+                auto response = respond(request);
+                if (settings.link_kib_per_second > 0)
+                    std::this_thread::sleep_for(std::chrono::duration<double>(
+                            static_cast<double>(size + response.size()) / 1024.0 / settings.link_kib_per_second));
+                if (SSL_write(ssl, response.data(), static_cast<int>(response.size())) <= 0) break;
+                bytes_out += response.size();
+                if (!request.keep_alive) break;
+            }
+            SSL_shutdown(ssl);
+        }
+
+        SSL_free(ssl);
+        std::lock_guard lock(connections_mutex);
+        ::close(fd);
+        connection.fd = -1;
+        connection.finished = true;
+    }
+
+    void accept_loop() {
+        while (running) {
+            int fd = ::accept(listener, nullptr, nullptr);
+            if (fd < 0) {
+                if (running && errno == EINTR) continue;
+                break;
+            }
+            int one = 1;
+            setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+            ++accepted;
+
+            std::lock_guard lock(connections_mutex);
+            for (auto it = connections.begin(); it != connections.end();) {
+                if (!it->finished) ++it;
+                else {
+                    it->worker.join();
+                    it = connections.erase(it);
+                }
+            }
+            auto& connection = connections.emplace_back(Connection{fd, {}});
+            connection.worker = std::thread([this, &connection] { serve(connection); });
+        }
+    }
+
+public:
+    MockFortiGate() : MockFortiGate(Settings{}) {}
+    explicit MockFortiGate(Settings settings) : settings(std::move(settings)), random(this->settings.seed) {}
+
+    MockFortiGate(const MockFortiGate&) = delete;
+    MockFortiGate& operator=(const MockFortiGate&) = delete;
+
+    ~MockFortiGate() { stop(); }
+
+    // generates data and certificate, binds and starts accepting; returns the bound port
+    unsigned short start() {
+        std::signal(SIGPIPE, SIG_IGN);  // a client hanging up mid-response must not take the process down
+        generate();
+        create_context();
+
+        listener = ::socket(AF_INET, SOCK_STREAM, 0);
+        int one = 1;
+        setsockopt(listener, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+
+        sockaddr_in address{};
+        address.sin_family = AF_INET;
+        address.sin_port = htons(settings.port);
+        address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        if (::bind(listener, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0 || ::listen(listener, 512) != 0)
+            throw std::runtime_error(std::format("MockFortiGate: unable to listen on port {}", settings.port));
+
+        socklen_t length = sizeof(address);
+        getsockname(listener, reinterpret_cast<sockaddr*>(&address), &length);
+        settings.port = ntohs(address.sin_port);
+
+        running = true;
+        acceptor = std::thread([this] { accept_loop(); });
+        return settings.port;
+    }
+
+    void stop() {
+        if (!running.exchange(false)) return;
+        ::shutdown(listener, SHUT_RDWR);
+        ::close(listener);
+        if (acceptor.joinable()) acceptor.join();
+
+        std::list<Connection> closing;
+        {
+            std::lock_guard lock(connections_mutex);
+            for (auto& connection : connections) if (connection.fd >= 0) ::shutdown(connection.fd, SHUT_RDWR);
+            closing.splice(closing.end(), connections);
+        }
+        for (auto& connection : closing) if (connection.worker.joinable()) connection.worker.join();
+        SSL_CTX_free(context);
+        context = nullptr;
+    }
+
+    [[nodiscard]] unsigned short port() const { return settings.port; }
+    [[nodiscard]] const std::string& ca_cert_path() const { return settings.ca_cert_path; }
+
+    [[nodiscard]] Stats stats() const {
+        return {requests.load(), errors.load(), accepted.load(), bytes_in.load(), bytes_out.load()};
+    }
+};
+
+#endif //FORTI_API_MOCK_FORTIGATE_HPP
@@ -0,0 +1,76 @@
+#include <csignal>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <string_view>
+#include "mock_fortigate.hpp"
+
+/*
+ * Standalone mock FortiGate for manual testing and external load tools:
+ *
+ *     mock-fortigate --port 8443 --ca /tmp/mock-ca.pem --latency-ms 5 --error-rate 0.01
+ *
+ * then point forti-api at it with FORTIGATE_GATEWAY_IP=127.0.0.1, FORTIGATE_ADMIN_HTTPS_PORT=8443 and
+ * PATH_TO_FORTIGATE_CA_CERT=/tmp/mock-ca.pem (any API key is accepted).
+ */
+
+static void usage() {
+    std::cerr << "usage: mock-fortigate [--port N] [--ca PATH] [--latency-ms MS] [--jitter-ms MS] [--error-rate P]\n"
+                 "                      [--error-status CODE] [--policies N] [--services N] [--profiles N]\n"
+                 "                      [--feeds N] [--feed-entries N] [--interfaces N] [--gzip-min-length BYTES]\n"
+                 "                      [--accept-encoded-requests 0|1] [--link-kib-s KIB_PER_SECOND]\n";
+}
+
+int main(int argc, char **argv) {
+    MockFortiGate::Settings settings;
+    settings.port = 8443;
+
+    for (int i = 1; i < argc; ++i) {
+        std::string_view flag = argv[i];
+        if (i + 1 >= argc) {
+            usage();
+            return 1;
+        }
+        std::string value = argv[++i];
+
+        if (flag == "--port") settings.port = static_cast<unsigned short>(std::stoi(value));
+        else if (flag == "--ca") settings.ca_cert_path = value;
+        else if (flag == "--latency-ms") settings.latency = std::chrono::microseconds(static_cast<long long>(std::stod(value) * 1000));
+        else if (flag == "--jitter-ms") settings.jitter = std::chrono::microseconds(static_cast<long long>(std::stod(value) * 1000));
+        else if (flag == "--error-rate") settings.error_rate = std::stod(value);
+        else if (flag == "--error-status") settings.error_status = std::stoi(value);
+        else if (flag == "--policies") settings.policies = std::stoul(value);
+        else if (flag == "--services") settings.services = std::stoul(value);
+        else if (flag == "--profiles") settings.profiles = std::stoul(value);
+        else if (flag == "--feeds") settings.feeds = std::stoul(value);
+        else if (flag == "--feed-entries") settings.feed_entries = std::stoul(value);
+        else if (flag == "--interfaces") settings.interfaces = std::stoul(value);
+        else if (flag == "--gzip-min-length") settings.gzip_min_length = std::stoul(value);
+        else if (flag == "--link-kib-s") settings.link_kib_per_second = std::stod(value);
+        else if (flag == "--accept-encoded-requests") settings.accept_encoded_requests = value != "0";
+        else {
+            usage();
+            return 1;
+        }
+    }
+
+    sigset_t signals;
+    sigemptyset(&signals);
+    sigaddset(&signals, SIGINT);
+    sigaddset(&signals, SIGTERM);
+    pthread_sigmask(SIG_BLOCK, &signals, nullptr);  // inherited by the server threads
+
+    MockFortiGate server(settings);
+    auto port = server.start();
+    std::cout << std::format("[INFO] mock FortiGate listening on https://127.0.0.1:{} (CA: {})", port,
+                             server.ca_cert_path()) << std::endl;
+
+    int signal = 0;
+    sigwait(&signals, &signal);
+    server.stop();
+
+    auto stats = server.stats();
+    std::cout << std::format("[INFO] served {} requests ({} injected errors) over {} connections", stats.requests,
+                             stats.errors, stats.connections) << std::endl;
+    return 0;
+}
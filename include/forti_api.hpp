@@ -6,8 +6,11 @@
 #define FORTI_API_H
 
 #include "forti_api/threat_feed.hpp"
+#include "forti_api/feed_sync.hpp"
 #include "forti_api/dns_filter.hpp"
 #include "forti_api/system.hpp"
 #include "forti_api/firewall.hpp"
+#include "forti_api/config_watcher.hpp"
+#include "forti_api/prepared_request.hpp"
 
 #endif //FORTI_API_H
@@ -15,161 +15,136 @@
 #include <utility>
 #include <cstdlib>
 #include <stdexcept>
-#include <regex>
+#include <future>
+#include <limits>
+#include <memory>
+#include <type_traits>
+#include <chrono>
+#include <concepts>
+#include <optional>
+#include <thread>
+#include "client.hpp"
+#include "connection_pool.hpp"
+#include "async_engine.hpp"
+#include "metrics.hpp"
+#include "throttle.hpp"
+#include "body.hpp"
+#include "cache.hpp"
+#include "compression.hpp"
+#include "stream.hpp"
+#include "types/lazy_response.h"
 #include "types/response.h"
 
-inline static std::regex ipv4("(([0-9]|[1-9][0-9]|1[0-9][0-9]|2[0-4][0-9]|25[0-5])\\.){3}([0-9]|[1-9][0-9]|1[0-9][0-9]|2[0-4][0-9]|25[0-5])");
-inline static std::regex ipv6("((([0-9a-fA-F]){1,4})\\:){7}([0-9a-fA-F]){1,4}");
-
-inline static nlohmann::json convert_keys_to_hyphens(const nlohmann::json& j) {
-    nlohmann::json result;
-
-    std::array<std::string, 10> ignore_keys{
-            "q_origin_key"
-    };
-
-    for (auto it = j.begin(); it != j.end(); ++it) {
-        std::string key = it.key();
+/*
+ * Process-wide FortiGate settings, used whenever no FortiClient is active on the calling thread.
+ *
+ * The settings live in one immutable ConfigSnapshot that setters replace with an atomic pointer swap, so keys and
+ * certificates can be rotated while requests are running: those in flight finish with the snapshot they started
+ * with, later ones pick up the new one.  configure() replaces every field in a single swap; the individual setters
+ * are serialised among themselves but never block a request.
+ */
+class FortiAuth {
+    inline static std::mutex writer;
+    inline static std::atomic<std::shared_ptr<const ConfigSnapshot>> current{
+            std::make_shared<const ConfigSnapshot>(ClientConfig{.admin_https_port = 0})};
 
-        // Ignore certain keys
-        bool should_process = true;
-        for (const auto& ignore : ignore_keys) {
-            if (key == ignore) {
-                should_process = false;
-                break;
-            }
+    // quiet: nothing is printed and a missing required variable throws; otherwise every missing one is logged
+    static std::string check_env(const char* env_var_name, bool quiet = false, bool required = true) {
+        const char* value = std::getenv(env_var_name);
+        if (value == nullptr) {
+            if (!quiet)
+                std::cerr << "[DEBUG] Missing required field: '" << env_var_name
+                          << "'. Please set this in your environment.\n";
+            else if (required)
+                throw std::runtime_error(std::format("Missing environment variable '{}'", env_var_name));
+            return "";
         }
-        if (!should_process) continue;
-
-        // Replace underscores with hyphens in the key
-        std::replace(key.begin(), key.end(), '_', '-');
-
-        // Recursively process objects and arrays
-        if (it->is_object()) result[key] = convert_keys_to_hyphens(*it);
-        else if (it->is_array()) {
-            nlohmann::json array_result = nlohmann::json::array();
-            for (const auto& elem : *it) {  // Use *it instead of it.value()
-                if (elem.is_object()) array_result.push_back(convert_keys_to_hyphens(elem));
-                else array_result.push_back(elem);  // Directly add the element if it's not an object
-            }
-            result[key] = array_result;
-        } else result[key] = *it;  // Directly copy the value if it's neither an object nor array
+        return value;
     }
 
-    return result;
-}
-
-inline static nlohmann::json convert_keys_to_underscores(const nlohmann::json& j) {
-    nlohmann::json result;
-
-    for (auto it = j.begin(); it != j.end(); ++it) {
-        std::string key = it.key();
-        std::replace(key.begin(), key.end(), '-', '_');
-
-        if (it->is_object()) result[key] = convert_keys_to_underscores(*it);
-        else if (it->is_array()) {
-            nlohmann::json array_result = nlohmann::json::array();
-            for (const auto& elem : *it) {  // Use *it instead of it.value()
-                if (elem.is_object()) array_result.push_back(convert_keys_to_underscores(elem));
-                else array_result.push_back(elem);  // Directly add the element if it's not an object
-            }
-            result[key] = array_result;
-        } else result[key] = *it;  // Directly copy the value if it's neither an object nor array
+    template<typename F>
+    static void update(F change) {
+        std::lock_guard lock(writer);
+        auto next = current.load()->config;
+        change(next);
+        current.store(std::make_shared<const ConfigSnapshot>(std::move(next)));
     }
 
-    return result;
-}
-
-class FortiAuth {
-    inline static unsigned int admin_https_port = 0;
-    inline static std::string gateway_ip;
-    inline static std::string ca_cert_path;
-    inline static std::string ssl_cert_path;
-    inline static std::string cert_password;
-    inline static std::string api_key;
-    inline static std::string auth_header;
-
-    static std::string check_env(const char* env_var_name) {
-        const char* value = std::getenv(env_var_name);
-        if (value == nullptr) {
-            std::cerr << "[DEBUG] Missing required field: '" << env_var_name << "'. Please set this in your environment.\n";
-            return "";
-        }
+    static const std::string& warn_if_empty(const std::string& value, const char* name) {
+        if (PROGRAM_IS_RUNNING && value.empty()) std::cerr << "[WARNING] " << name << " is uninitialized!\n";
         return value;
     }
 
 public:
-    inline static bool PROGRAM_IS_RUNNING = false;
+    inline static std::atomic<bool> PROGRAM_IS_RUNNING = false;
+
+    // FORTIGATE_GATEWAY_IP, FORTIGATE_ADMIN_HTTPS_PORT, PATH_TO_FORTIGATE_CA_CERT, PATH_TO_FORTIGATE_SSL_CERT,
+    // FORTIGATE_SSL_CERT_PASS and FORTIGATE_API_KEY.  `quiet` (for pollers such as ConfigWatcher) prints nothing,
+    // lets the certificate variables be unset and throws when the gateway, port or API key is missing.
+    static ClientConfig config_from_env(bool quiet = false) {
+        ClientConfig config;
+        config.admin_https_port = std::stoi(check_env("FORTIGATE_ADMIN_HTTPS_PORT", quiet));
+        config.gateway_ip = check_env("FORTIGATE_GATEWAY_IP", quiet);
+        config.ca_cert_path = check_env("PATH_TO_FORTIGATE_CA_CERT", quiet, false);
+        config.ssl_cert_path = check_env("PATH_TO_FORTIGATE_SSL_CERT", quiet, false);
+        config.cert_password = check_env("FORTIGATE_SSL_CERT_PASS", quiet, false);
+        config.api_key = check_env("FORTIGATE_API_KEY", quiet);
+        return config;
+    }
+
+    static void set_vars_from_env() { configure(config_from_env()); }
 
-    static void set_vars_from_env() {
-        set_admin_https_port(std::stoi(check_env("FORTIGATE_ADMIN_HTTPS_PORT")));
-        set_gateway_ip(check_env("FORTIGATE_GATEWAY_IP"));
-        set_ca_cert_path(check_env("PATH_TO_FORTIGATE_CA_CERT"));
-        set_ssl_cert_path(check_env("PATH_TO_FORTIGATE_SSL_CERT"));
-        set_cert_password(check_env("FORTIGATE_SSL_CERT_PASS"));
-        set_api_key(check_env("FORTIGATE_API_KEY"));
-        set_auth_header();
+    static void configure(ClientConfig config) {
+        std::lock_guard lock(writer);
+        current.store(std::make_shared<const ConfigSnapshot>(std::move(config)));
     }
 
-    static void set_admin_https_port(unsigned int port) { admin_https_port = port; }
+    [[nodiscard]] static std::shared_ptr<const ConfigSnapshot> snapshot() { return current.load(); }
 
-    static void set_gateway_ip(const std::string& ip) { gateway_ip = ip; }
+    static void set_admin_https_port(unsigned int port) { update([&](ClientConfig& c) { c.admin_https_port = port; }); }
 
-    static void set_ca_cert_path(const std::string& path) { ca_cert_path = path; }
+    static void set_gateway_ip(const std::string& ip) { update([&](ClientConfig& c) { c.gateway_ip = ip; }); }
 
-    static void set_ssl_cert_path(const std::string& path) { ssl_cert_path = path; }
+    static void set_ca_cert_path(const std::string& path) { update([&](ClientConfig& c) { c.ca_cert_path = path; }); }
 
-    static void set_cert_password(const std::string& password) { cert_password = password; }
+    static void set_ssl_cert_path(const std::string& path) { update([&](ClientConfig& c) { c.ssl_cert_path = path; }); }
 
-    static void set_api_key(const std::string& key) {
-        api_key = key;
-        set_auth_header();
+    static void set_cert_password(const std::string& password) {
+        update([&](ClientConfig& c) { c.cert_password = password; });
     }
 
-    static void set_auth_header() { if (!api_key.empty()) auth_header = "Authorization: Bearer " + api_key; }
+    static void set_api_key(const std::string& key) { update([&](ClientConfig& c) { c.api_key = key; }); }
+
+    // the auth header is derived from the API key whenever the snapshot is rebuilt
+    static void set_auth_header() {}
 
     static unsigned int get_admin_https_port() {
-        if (PROGRAM_IS_RUNNING && admin_https_port == 0) {
-            std::cerr << "[WARNING] admin_ssh_port is uninitialized!\n";
-        }
-        return admin_https_port;
+        auto port = snapshot()->config.admin_https_port;
+        if (PROGRAM_IS_RUNNING && port == 0) std::cerr << "[WARNING] admin_ssh_port is uninitialized!\n";
+        return port;
     }
 
-    static std::string get_gateway_ip() {
-        if (PROGRAM_IS_RUNNING && gateway_ip.empty()) std::cerr << "[WARNING] gateway_ip is uninitialized!\n";
-        return gateway_ip;
-    }
+    static std::string get_gateway_ip() { return warn_if_empty(snapshot()->config.gateway_ip, "gateway_ip"); }
 
-    static std::string get_ca_cert_path() {
-        if (PROGRAM_IS_RUNNING && ca_cert_path.empty()) std::cerr << "[WARNING] ca_cert_path is uninitialized!\n";
-        return ca_cert_path;
-    }
+    static std::string get_ca_cert_path() { return warn_if_empty(snapshot()->config.ca_cert_path, "ca_cert_path"); }
 
-    static std::string get_ssl_cert_path() {
-        if (PROGRAM_IS_RUNNING && ssl_cert_path.empty()) std::cerr << "[WARNING] ssl_cert_path is uninitialized!\n";
-        return ssl_cert_path;
-    }
+    static std::string get_ssl_cert_path() { return warn_if_empty(snapshot()->config.ssl_cert_path, "ssl_cert_path"); }
 
-    static std::string get_cert_password() {
-        if (PROGRAM_IS_RUNNING && cert_password.empty()) std::cerr << "[WARNING] cert_password is uninitialized!\n";
-        return cert_password;
-    }
+    static std::string get_cert_password() { return warn_if_empty(snapshot()->config.cert_password, "cert_password"); }
 
-    static std::string get_api_key() {
-        if (PROGRAM_IS_RUNNING && api_key.empty()) std::cerr << "[WARNING] api_key is uninitialized!\n";
-        return api_key;
-    }
+    static std::string get_api_key() { return warn_if_empty(snapshot()->config.api_key, "api_key"); }
 
-    static std::string get_auth_header() {
-        if (PROGRAM_IS_RUNNING && auth_header.empty()) std::cerr << "[WARNING] auth_header is uninitialized!\n";
-        return auth_header;
-    }
+    static std::string get_auth_header() { return warn_if_empty(snapshot()->auth_header, "auth_header"); }
 };
 
 
 class FortiAPI {
-    inline static std::string BASE_API_ENDPOINT() {
-        return std::format("https://{}:{}/api/v2", FortiAuth::get_gateway_ip(), FortiAuth::get_admin_https_port());
+    friend class PreparedRequest;
+
+    // the settings of the FortiGate this thread is talking to: the active FortiClient's, else FortiAuth's
+    static std::shared_ptr<const ConfigSnapshot> settings() {
+        if (auto client = FortiClient::current()) return client->config();
+        return FortiAuth::snapshot();
     }
 
     static size_t WriteCallback(void *contents, size_t size, size_t nmemb, void *userp) {
@@ -177,6 +152,36 @@ class FortiAPI {
         return size * nmemb;
     }
 
+    struct StreamContext {
+        JsonArrayStream splitter;
+        std::exception_ptr error;
+    };
+
+    static size_t StreamCallback(void *contents, size_t size, size_t nmemb, void *userp) {
+        auto *context = static_cast<StreamContext*>(userp);
+        try {
+            context->splitter.feed({static_cast<char*>(contents), size * nmemb});
+        } catch (...) {
+            context->error = std::current_exception();
+            return 0;  // aborts the transfer with CURLE_WRITE_ERROR
+        }
+        return size * nmemb;
+    }
+
+    static size_t ReadCallback(char *buffer, size_t size, size_t nitems, void *userp) {
+        try {
+            return static_cast<BodyWriter*>(userp)->read(buffer, size * nitems);
+        } catch (...) {
+            return CURL_READFUNC_ABORT;
+        }
+    }
+
+    // curl only ever rewinds an upload to its first byte (redirects, connection re-use after a reset)
+    static int SeekCallback(void *userp, curl_off_t offset, int origin) {
+        if (offset != 0 || origin != SEEK_SET) return CURL_SEEKFUNC_CANTSEEK;
+        return static_cast<BodyWriter*>(userp)->rewind() ? CURL_SEEKFUNC_OK : CURL_SEEKFUNC_CANTSEEK;
+    }
+
     static int curl_debug_callback(CURL *handle, curl_infotype type, char *data, size_t size, void *userptr) {
         switch (type) {
             case CURLINFO_TEXT:
@@ -206,71 +211,440 @@ class FortiAPI {
         return 0;
     }
 
-    template<typename T>
-    static T request(const std::string &method, const std::string &path, const nlohmann::json &data = {}) {
+    // everything a single transfer needs to stay alive until curl is done with the handle
+    struct Transfer {
+        ConnectionPool::Lease connection;
+        std::shared_ptr<const ConfigSnapshot> settings;  // kept alive until the transfer is done, even across a reload
+        std::string method, path, url, payload, body;
+        struct curl_slist *headers = nullptr;
+        std::shared_ptr<const std::string> certificate;
+        curl_blob certificate_blob{};
+        std::unique_ptr<BodyWriter> encoder;  // gzip stage in front of a streamed body
+        bool compressed = false;              // the request body is sent gzip-encoded
+        Metrics::Series *series = nullptr;  // resolved once by transfers that are performed over and over
+
+        explicit Transfer(ConnectionPool::Lease connection) : connection(std::move(connection)) {}
+        Transfer(const Transfer&) = delete;
+        Transfer& operator=(const Transfer&) = delete;
+        ~Transfer() { curl_slist_free_all(headers); }
+
+        [[nodiscard]] CURL* handle() const { return connection.get(); }
+    };
+
+    static std::unique_ptr<Transfer> prepare(std::shared_ptr<const ConfigSnapshot> config, const std::string &method,
+                                             const std::string &path) {
         if (!FortiAuth::PROGRAM_IS_RUNNING) FortiAuth::PROGRAM_IS_RUNNING = true;
 
-        CURL *curl;
-        CURLcode res;
-        std::string readBuffer;
-
-        curl = curl_easy_init();
-        if (curl) {
-            std::string url = BASE_API_ENDPOINT() + path;
-
-            struct curl_slist *headers = nullptr;
-            headers = curl_slist_append(headers, "Content-Type: application/json");
-            headers = curl_slist_append(headers, FortiAuth::get_auth_header().c_str());
-
-            curl_easy_setopt(curl, CURLOPT_SSL_SESSIONID_CACHE, 1L);
-            curl_easy_setopt(curl, CURLOPT_FORBID_REUSE, 0L);
-            curl_easy_setopt(curl, CURLOPT_FRESH_CONNECT, 0L);
-            curl_easy_setopt(curl, CURLOPT_DNS_CACHE_TIMEOUT, -1);
-            curl_easy_setopt(curl, CURLOPT_HTTPHEADER, headers);
-            curl_easy_setopt(curl, CURLOPT_URL, url.c_str());
-            curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, WriteCallback);
-            curl_easy_setopt(curl, CURLOPT_WRITEDATA, &readBuffer);
-            curl_easy_setopt(curl, CURLOPT_SSL_VERIFYPEER, 1L);
-            curl_easy_setopt(curl, CURLOPT_SSL_VERIFYHOST, 1L);
+        auto transfer = std::make_unique<Transfer>(ConnectionPool::acquire(config->gateway));
+        CURL *curl = transfer->handle();
+        transfer->method = method;
+        transfer->path = path;
+        transfer->url = config->base_url + path;
+
+        transfer->headers = curl_slist_append(transfer->headers, "Content-Type: application/json");
+        transfer->headers = curl_slist_append(transfer->headers, config->auth_header.c_str());
+
+        transfer->connection.apply_connection_options();
+        curl_easy_setopt(curl, CURLOPT_HTTPHEADER, transfer->headers);
+        curl_easy_setopt(curl, CURLOPT_URL, transfer->url.c_str());
+        curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, WriteCallback);
+        curl_easy_setopt(curl, CURLOPT_WRITEDATA, &transfer->body);
+        curl_easy_setopt(curl, CURLOPT_SSL_VERIFYPEER, 1L);
+        curl_easy_setopt(curl, CURLOPT_SSL_VERIFYHOST, 1L);
+        curl_easy_setopt(curl, CURLOPT_CAINFO, config->config.ca_cert_path.c_str());
+        if (Compression::accept_responses) curl_easy_setopt(curl, CURLOPT_ACCEPT_ENCODING, "");  // all built-in
+
+        // the P12 bundle is read once per config snapshot and handed to curl from memory
+        if (auto certificate = config->certificate()) {
+            transfer->certificate = std::move(certificate);
+            transfer->certificate_blob = {const_cast<char*>(transfer->certificate->data()),
+                                          transfer->certificate->size(), CURL_BLOB_NOCOPY};
             curl_easy_setopt(curl, CURLOPT_SSLCERTTYPE, "P12");  // Explicitly set certificate type to P12
-            curl_easy_setopt(curl, CURLOPT_CAINFO, FortiAuth::get_ca_cert_path().c_str());
-            curl_easy_setopt(curl, CURLOPT_SSLCERT, FortiAuth::get_ssl_cert_path().c_str());
-            curl_easy_setopt(curl, CURLOPT_KEYPASSWD, FortiAuth::get_cert_password().c_str());
-
-            std::string json_payload = convert_keys_to_hyphens(data).dump();  // do not simplify by deleting this
-            if (method == "POST" || method == "PUT")
-                curl_easy_setopt(curl, CURLOPT_POSTFIELDS, json_payload.c_str());
+            curl_easy_setopt(curl, CURLOPT_SSLCERT_BLOB, &transfer->certificate_blob);
+            curl_easy_setopt(curl, CURLOPT_KEYPASSWD, config->config.cert_password.c_str());
+        }
+        transfer->settings = std::move(config);
 
-            if (method != "POST" && method != "GET")
-                curl_easy_setopt(curl, CURLOPT_CUSTOMREQUEST, method.c_str());
+        if (method != "POST" && method != "GET")
+            curl_easy_setopt(curl, CURLOPT_CUSTOMREQUEST, transfer->method.c_str());
 
 #ifdef ENABLE_DEBUG
-            curl_easy_setopt(curl, CURLOPT_VERBOSE, 1L);
-            curl_easy_setopt(curl, CURLOPT_DEBUGFUNCTION, curl_debug_callback);
-            curl_easy_setopt(curl, CURLOPT_DEBUGDATA, nullptr);
+        curl_easy_setopt(curl, CURLOPT_VERBOSE, 1L);
+        curl_easy_setopt(curl, CURLOPT_DEBUGFUNCTION, curl_debug_callback);
+        curl_easy_setopt(curl, CURLOPT_DEBUGDATA, nullptr);
 #endif
 
-            res = curl_easy_perform(curl);
-            if (res != CURLE_OK) std::cerr << "curl_easy_perform() failed: " << curl_easy_strerror(res) << std::endl;
-            curl_easy_cleanup(curl);
+        return transfer;
+    }
+
+    static std::unique_ptr<Transfer> prepare(const std::string &method, const std::string &path) {
+        return prepare(settings(), method, path);
+    }
+
+    static std::unique_ptr<Transfer> prepare(std::shared_ptr<const ConfigSnapshot> config, const std::string &method,
+                                             const std::string &path, const nlohmann::json &data) {
+        auto transfer = prepare(std::move(config), method, path);
+        transfer->payload = data.dump();  // wire keys come straight from the FORTI_API_DEFINE_TYPE_* mappings
+        if (method == "POST" || method == "PUT") {
+            if (Compression::compress_request(transfer->settings->gateway, transfer->payload.size())) {
+                transfer->payload = Compression::gzip(transfer->payload);
+                transfer->compressed = true;
+                transfer->headers = curl_slist_append(transfer->headers, "Content-Encoding: gzip");
+            }
+            curl_easy_setopt(transfer->handle(), CURLOPT_POSTFIELDSIZE_LARGE,
+                             static_cast<curl_off_t>(transfer->payload.size()));
+            curl_easy_setopt(transfer->handle(), CURLOPT_POSTFIELDS, transfer->payload.data());
         }
+        return transfer;
+    }
 
-        return convert_keys_to_underscores(nlohmann::json::parse(readBuffer));
+    static std::unique_ptr<Transfer> prepare(const std::string &method, const std::string &path,
+                                             const nlohmann::json &data) {
+        return prepare(settings(), method, path, data);
     }
 
-    static Response validate(const std::string &method, const std::string &path, const nlohmann::json &data = {}) {
-        auto response = request<Response>(method, path, data);
+    // the body is pulled from `body` as curl sends it, with chunked transfer encoding since its size is never known
+    static std::unique_ptr<Transfer> prepare(const std::string &method, const std::string &path, BodyWriter &body) {
+        auto transfer = prepare(method, path);
+        CURL *curl = transfer->handle();
+
+        BodyWriter *source = &body;
+        if (Compression::compress_request(transfer->settings->gateway, std::numeric_limits<std::size_t>::max())) {
+            transfer->encoder = std::make_unique<GzipBodyWriter>(body);  // the size is unknown, so always worth it
+            source = transfer->encoder.get();
+            transfer->compressed = true;
+            transfer->headers = curl_slist_append(transfer->headers, "Content-Encoding: gzip");
+        }
+        transfer->headers = curl_slist_append(transfer->headers, "Transfer-Encoding: chunked");
+        transfer->headers = curl_slist_append(transfer->headers, "Expect:");  // no 100-continue round trip
+        if (method == "POST") curl_easy_setopt(curl, CURLOPT_POST, 1L);
+        else curl_easy_setopt(curl, CURLOPT_UPLOAD, 1L);
+        curl_easy_setopt(curl, CURLOPT_READFUNCTION, ReadCallback);
+        curl_easy_setopt(curl, CURLOPT_READDATA, source);
+        curl_easy_setopt(curl, CURLOPT_SEEKFUNCTION, SeekCallback);
+        curl_easy_setopt(curl, CURLOPT_SEEKDATA, source);
+        curl_easy_setopt(curl, CURLOPT_UPLOAD_BUFFERSIZE, upload_buffer_size);
+        return transfer;
+    }
+
+    static Metrics::Series* record(const Transfer &transfer, CURLcode res) {
+        if (transfer.series) return Metrics::record(*transfer.series, transfer.handle(), res);
+        return Metrics::record(transfer.handle(), transfer.method, transfer.path, res);
+    }
+
+    // a gateway that answers a gzip-encoded body with 415 gets plain bodies from now on
+    static bool refused_encoding(Transfer &transfer, CURLcode res) {
+        if (!transfer.compressed || res != CURLE_OK) return false;
+        long status = 0;
+        curl_easy_getinfo(transfer.handle(), CURLINFO_RESPONSE_CODE, &status);
+        if (status != 415) return false;
+        Compression::decline(transfer.settings->gateway);
+        return true;
+    }
+
+    /*
+     * Transport failures and empty bodies surface as exceptions instead of a confusing parse error.  A write drops the
+     * cached reads of its table here, once it is done (failed ones too, they may have been applied) but before its
+     * caller sees the outcome, so a read racing the write can't re-cache the old table.
+     */
+    static Metrics::Series* settle(Transfer &transfer, CURLcode res) {
+        if (transfer.method != "GET") CmdbCache::invalidate(transfer.settings->gateway, transfer.path);
+        auto *series = record(transfer, res);
+        if (res != CURLE_OK)
+            throw std::runtime_error(std::format("{} {} failed: {}", transfer.method, transfer.url,
+                                                 curl_easy_strerror(res)));
+        transfer.connection.record();
+        refused_encoding(transfer, res);
+
+        if (transfer.body.empty()) {
+            long status = 0;
+            curl_easy_getinfo(transfer.handle(), CURLINFO_RESPONSE_CODE, &status);
+            throw std::runtime_error(std::format("{} {} returned HTTP {} with an empty body", transfer.method,
+                                                 transfer.url, status));
+        }
+        return series;
+    }
+
+    template<typename T>
+    static T decode(Transfer &transfer, Metrics::Series *series) {
+        auto decode_start = std::chrono::steady_clock::now();
+        std::optional<T> result;
+        if constexpr (requires { { T::from_body(std::string()) } -> std::same_as<std::optional<T>>; })
+            result = T::from_body(std::move(transfer.body));
+        else if constexpr (std::is_same_v<T, Response>) {
+            // only the envelope is needed: past a few KiB (results worth skipping) the results array is never parsed
+            auto document = transfer.body.size() > envelope_scan_threshold
+                            ? nlohmann::json::parse(JsonArrayStream::split(transfer.body).envelope, nullptr, false)
+                            : nlohmann::json::parse(transfer.body, nullptr, false);
+            if (!document.is_discarded()) result = document;
+        } else {
+            auto document = nlohmann::json::parse(transfer.body, nullptr, false);
+            if (!document.is_discarded()) result = document;
+        }
+        if (!result) {
+            long status = 0;
+            curl_easy_getinfo(transfer.handle(), CURLINFO_RESPONSE_CODE, &status);
+            throw std::runtime_error(std::format("{} {} returned HTTP {} with a non-JSON body", transfer.method,
+                                                 transfer.url, status));
+        }
+        Metrics::record_decode(series, std::chrono::steady_clock::now() - decode_start);
+        return std::move(*result);
+    }
+
+    template<typename T>
+    static T complete(Transfer &transfer, CURLcode res) { return decode<T>(transfer, settle(transfer, res)); }
+
+    // a failed idempotent attempt worth repeating: record it, slow the endpoint class down and pick the backoff
+    static std::optional<std::chrono::milliseconds> retry_delay(Transfer &transfer, CURLcode res, unsigned int attempt,
+                                                                const Throttle::Permit &permit) {
+        long status = 0;
+        curl_easy_getinfo(transfer.handle(), CURLINFO_RESPONSE_CODE, &status);
+        if (transfer.method != "GET" || attempt >= Throttle::retry.max_attempts || !Throttle::congested(res, status))
+            return std::nullopt;
+
+        record(transfer, res);
+        permit.observe(transfer.handle(), res);
+
+        curl_off_t retry_after = 0;
+        curl_easy_getinfo(transfer.handle(), CURLINFO_RETRY_AFTER, &retry_after);
+        return Throttle::backoff(attempt, retry_after);
+    }
+
+    // blocking requests to an HTTP/2 gateway ride the AsyncEngine so concurrent callers share one connection
+    template<typename T>
+    static T request(const std::string &method, const std::string &path, const nlohmann::json &data = {}) {
+        if (ConnectionPool::multiplexed(gateway()))
+            return request_async<T>(method, path, data, [](T result) { return result; }).get();
+
+        auto permit = Throttle::acquire(Throttle::classify(method, path), gateway());
+        for (unsigned int attempt = 1;; ++attempt) {
+            auto transfer = prepare(method, path, data);
+            CURLcode res = curl_easy_perform(transfer->handle());
+            if (refused_encoding(*transfer, res)) continue;  // resent plain
+            if (auto delay = retry_delay(*transfer, res, attempt, permit)) {
+                std::this_thread::sleep_for(*delay);
+                continue;
+            }
+            permit.finish(transfer->handle(), res);
+            return complete<T>(*transfer, res);
+        }
+    }
+
+    template<typename T, typename F>
+    struct AsyncCall {
+        using Result = std::invoke_result_t<F, T>;
+
+        std::shared_ptr<Transfer> transfer;
+        nlohmann::json data;  // kept only for a compressed body, to resend it plain if the gateway answers 415
+        Throttle::Permit permit;
+        std::promise<Result> promise;
+        F then;
+        unsigned int attempt = 1;
+
+        explicit AsyncCall(F then) : then(std::move(then)) {}
+
+        static void on_done(const std::shared_ptr<AsyncCall> &call, CURLcode res) {
+            try {
+                if (refused_encoding(*call->transfer, res)) {  // resent plain, with the settings it was prepared for
+                    auto &sent = *call->transfer;
+                    call->transfer = prepare(sent.settings, sent.method, sent.path, call->data);
+                    AsyncEngine::submit(call->transfer->handle(), [call](CURLcode next) { on_done(call, next); });
+                    return;
+                }
+                if (auto delay = retry_delay(*call->transfer, res, call->attempt, call->permit)) {
+                    ++call->attempt;
+                    call->transfer->body.clear();
+                    AsyncEngine::submit_after(call->transfer->handle(),
+                                              [call](CURLcode next) { on_done(call, next); }, *delay);
+                    return;
+                }
+                call->permit.finish(call->transfer->handle(), res);
+                if constexpr (std::is_void_v<Result>) {
+                    call->then(complete<T>(*call->transfer, res));
+                    call->promise.set_value();
+                } else call->promise.set_value(call->then(complete<T>(*call->transfer, res)));
+            } catch (...) {
+                call->promise.set_exception(std::current_exception());
+            }
+        }
+    };
+
+    /*
+     * Same as request(), but the transfer runs on the AsyncEngine loop and `then` is applied to the decoded T there.
+     * The caller blocks only while the endpoint class is at its throttle limits; retries are scheduled on the loop.
+     */
+    template<typename T, typename F>
+    static auto request_async(const std::string &method, const std::string &path, const nlohmann::json &data, F then)
+            -> std::future<std::invoke_result_t<F, T>> {
+        auto call = std::make_shared<AsyncCall<T, F>>(std::move(then));
+        call->permit = Throttle::acquire(Throttle::classify(method, path), gateway());
+        call->transfer = prepare(method, path, data);
+        if (call->transfer->compressed) call->data = data;
+        auto future = call->promise.get_future();
+
+        AsyncEngine::submit(call->transfer->handle(), [call](CURLcode res) { AsyncCall<T, F>::on_done(call, res); });
+        return future;
+    }
+
+    static Response report(Response response) {
         if (response.status != "success") std::cerr << nlohmann::json(response).dump(4) << std::endl;
         return response;
     }
 
+    // a typed object or an already wire-spelled document, as opposed to raw caller JSON or a streamed body
+    template<typename T>
+    static constexpr bool wire_body = !std::same_as<T, nlohmann::json> && !std::derived_from<T, BodyWriter>;
+
+    template<typename T>
+    static decltype(auto) wire(const T &data) {
+        if constexpr (std::same_as<T, Wire::Document>) return (data.json);
+        else return nlohmann::json(data);
+    }
+
+    static Response validate(const std::string &method, const std::string &path, const nlohmann::json &data = {}) {
+        return report(request<Response>(method, path, data));
+    }
+
+    static Response validate(const std::string &method, const std::string &path, BodyWriter &body) {
+        auto permit = Throttle::acquire(Throttle::classify(method, path), gateway());
+        for (;;) {
+            auto transfer = prepare(method, path, body);
+            CURLcode res = curl_easy_perform(transfer->handle());
+            if (refused_encoding(*transfer, res)) {  // resent plain, from the first byte
+                if (body.rewind()) continue;
+                throw std::runtime_error(std::format("{} {} refused a gzip-encoded body that cannot be resent plain",
+                                                     method, transfer->url));
+            }
+            permit.finish(transfer->handle(), res);
+            return report(complete<Response>(*transfer, res));
+        }
+    }
+
+    static std::future<Response> validate_async(const std::string &method, const std::string &path,
+                                                const nlohmann::json &data = {}) {
+        return request_async<Response>(method, path, data, report);
+    }
+
+    // fresh entries are served as-is, stale ones are revalidated against the config revision before refetching
+    template<typename T>
+    static T cached_get(const std::string &path) {
+        auto scope = gateway();
+        auto cached = CmdbCache::lookup<T>(scope, path);
+        if (cached.value && cached.fresh) return *cached.value;
+
+        if (cached.value && !cached.revision.empty()) {
+            auto probe = request<Response>("GET", append_query(path, "format=q_origin_key&count=1"));
+            if (probe.revision == cached.revision) {
+                CmdbCache::revalidated<T>(scope, path);
+                return *cached.value;
+            }
+            CmdbCache::record_miss();
+        }
+
+        auto generation = CmdbCache::generation();
+        auto result = request<T>("GET", path);
+        if (result.status == "success") CmdbCache::store(scope, path, result, result.revision, generation);
+        return result;
+    }
+
 public:
+    // bytes curl asks a BodyWriter for per read; bounds the memory of a streamed upload
+    inline static long upload_buffer_size = 64 * 1024;
+
+    // bodies decoded only for their envelope (Response) are scanned past their results array above this size
+    inline static std::size_t envelope_scan_threshold = 4096;
+
+    // "host:port" of the FortiGate the calling thread is talking to; connections, throttles and caches are keyed by it
+    static std::string gateway() { return settings()->gateway; }
+
+    static std::string append_query(const std::string &path, const std::string &query) {
+        return path + (path.find('?') == std::string::npos ? '?' : '&') + query;
+    }
+
     template<typename T>
-    static T get(const std::string &path) { return request<T>("GET", path); }
+    static T get(const std::string &path) {
+        if constexpr (std::is_base_of_v<Response, T>) if (CmdbCache::cacheable(path)) return cached_get<T>(path);
+        return request<T>("GET", path);
+    }
+
+    /*
+     * Decodes the array at `target` (e.g. {"results"}) into Element objects while the body is still downloading and
+     * hands each one to `sink`; the returned Envelope is decoded from everything outside that array.
+     */
+    template<typename Element, typename Envelope = Response, typename Sink>
+    static Envelope stream(const std::string &path, const std::vector<std::string> &target, Sink sink,
+                           std::size_t limit = JsonArrayStream::default_limit) {
+        // elements reach the sink while downloading, so a streamed GET is throttled but never retried
+        auto permit = Throttle::acquire(Throttle::classify("GET", path), gateway());
+        auto transfer = prepare("GET", path);
+        StreamContext context{JsonArrayStream(target, StreamDecoder<Element, Sink>{std::move(sink)}, limit), nullptr};
+        curl_easy_setopt(transfer->handle(), CURLOPT_WRITEFUNCTION, StreamCallback);
+        curl_easy_setopt(transfer->handle(), CURLOPT_WRITEDATA, &context);
+
+        CURLcode res = curl_easy_perform(transfer->handle());
+        permit.finish(transfer->handle(), res);
+        auto *series = Metrics::record(transfer->handle(), transfer->method, path, res);
+        if (context.error) std::rethrow_exception(context.error);
+        if (res != CURLE_OK)
+            throw std::runtime_error(std::format("GET {} failed: {}", transfer->url, curl_easy_strerror(res)));
+
+        transfer->connection.record();
+        auto decode_start = std::chrono::steady_clock::now();
+        Envelope envelope = nlohmann::json::parse(context.splitter.remainder());
+        Metrics::record_decode(series, std::chrono::steady_clock::now() - decode_start);
+        return envelope;
+    }
+
+    // Typed objects are written with their compile-time wire keys and Wire::Document bodies are sent untouched; raw
+    // nlohmann::json from callers may use underscore keys and is hyphenated first (see Wire::hyphenate).
+    static Response post(const std::string &path, const nlohmann::json &data) {
+        return validate("POST", path, Wire::hyphenate(data));
+    }
+
+    static Response put(const std::string &path, const nlohmann::json &data) {
+        return validate("PUT", path, Wire::hyphenate(data));
+    }
+
+    template<typename T> requires wire_body<T>
+    static Response post(const std::string &path, const T &data) { return validate("POST", path, wire(data)); }
+
+    template<typename T> requires wire_body<T>
+    static Response put(const std::string &path, const T &data) { return validate("PUT", path, wire(data)); }
 
-    static Response post(const std::string &path, const nlohmann::json &data) { return validate("POST", path, data); }
-    static Response put(const std::string &path, const nlohmann::json &data) { return validate("PUT", path, data); }
     static Response del(const std::string &path) { return validate("DELETE", path); }
+
+    // streamed uploads: `body` is serialised on demand and must outlive the call
+    static Response post(const std::string &path, BodyWriter &body) { return validate("POST", path, body); }
+    static Response put(const std::string &path, BodyWriter &body) { return validate("PUT", path, body); }
+
+    template<typename T>
+    static std::future<T> get_async(const std::string &path) {
+        return request_async<T>("GET", path, {}, [](T result) { return result; });
+    }
+
+    // decode as T, then reduce to whatever the caller needs (e.g. `.results`) before fulfilling the future
+    template<typename T, typename F>
+    static auto get_async(const std::string &path, F then) { return request_async<T>("GET", path, {}, std::move(then)); }
+
+    static std::future<Response> post_async(const std::string &path, const nlohmann::json &data) {
+        return validate_async("POST", path, Wire::hyphenate(data));
+    }
+
+    static std::future<Response> put_async(const std::string &path, const nlohmann::json &data) {
+        return validate_async("PUT", path, Wire::hyphenate(data));
+    }
+
+    template<typename T> requires wire_body<T>
+    static std::future<Response> post_async(const std::string &path, const T &data) {
+        return validate_async("POST", path, wire(data));
+    }
+
+    template<typename T> requires wire_body<T>
+    static std::future<Response> put_async(const std::string &path, const T &data) {
+        return validate_async("PUT", path, wire(data));
+    }
+
+    static std::future<Response> del_async(const std::string &path) { return validate_async("DELETE", path); }
 };
 
 #endif //FORTI_API_API_HPP
@@ -0,0 +1,159 @@
+#ifndef FORTI_API_ASYNC_ENGINE_HPP
+#define FORTI_API_ASYNC_ENGINE_HPP
+
+#include <curl/curl.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <iostream>
+#include <mutex>
+#include <thread>
+#include <tuple>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include "connection_pool.hpp"  // pooled handles must outlive the loop, so the pool is initialised first
+
+
+/*
+ * Single event loop thread driving a curl_multi handle.
+ *
+ * Callers hand over a fully configured easy handle plus a completion callback; the loop adds it to the multi
+ * handle, drives every transfer in flight concurrently and invokes the callback (on the loop thread) once the
+ * transfer finished.  Completion callbacks must be cheap and must never block on another async request.
+ *
+ * Transfers to an HTTP/2 gateway (see ConnectionPool::http2) are multiplexed as streams over one connection, up to
+ * `max_concurrent_streams` at a time.
+ */
+class AsyncEngine {
+public:
+    using Completion = std::function<void(CURLcode)>;
+
+private:
+    struct State {
+        CURLM* multi = nullptr;
+        std::mutex mutex;
+        std::vector<std::pair<CURL*, Completion>> pending;
+        std::vector<std::tuple<std::chrono::steady_clock::time_point, CURL*, Completion>> delayed;
+        std::unordered_map<CURL*, Completion> active;
+        std::atomic<bool> running{false};
+        std::once_flag started;
+        std::thread loop;
+
+        State() {
+            curl_global_init(CURL_GLOBAL_DEFAULT);
+            multi = curl_multi_init();
+        }
+
+        ~State() {
+            if (running.exchange(false)) {
+                curl_multi_wakeup(multi);
+                loop.join();
+            }
+            for (auto& [handle, done] : active) curl_multi_remove_handle(multi, handle);
+            curl_multi_cleanup(multi);
+        }
+    };
+
+    inline static State state;
+
+    static void start() {
+        std::call_once(state.started, [] {
+            curl_multi_setopt(state.multi, CURLMOPT_MAX_HOST_CONNECTIONS, max_host_connections);
+            curl_multi_setopt(state.multi, CURLMOPT_MAX_TOTAL_CONNECTIONS, max_total_connections);
+            curl_multi_setopt(state.multi, CURLMOPT_PIPELINING, CURLPIPE_MULTIPLEX);
+            curl_multi_setopt(state.multi, CURLMOPT_MAX_CONCURRENT_STREAMS, max_concurrent_streams);
+            state.running = true;
+            state.loop = std::thread(run);
+        });
+    }
+
+    // moves due delayed handles into the pending batch and returns how long the loop may sleep
+    static int release_delayed(std::vector<std::pair<CURL*, Completion>>& pending) {
+        auto now = std::chrono::steady_clock::now();
+        auto timeout = std::chrono::milliseconds(poll_timeout_ms);
+        for (auto it = state.delayed.begin(); it != state.delayed.end();) {
+            auto& [due, handle, done] = *it;
+            if (due <= now) {
+                pending.emplace_back(handle, std::move(done));
+                it = state.delayed.erase(it);
+            } else {
+                timeout = std::min(timeout, std::chrono::ceil<std::chrono::milliseconds>(due - now));
+                ++it;
+            }
+        }
+        return static_cast<int>(timeout.count());
+    }
+
+    static int add_pending() {
+        std::vector<std::pair<CURL*, Completion>> pending;
+        int timeout;
+        {
+            std::lock_guard lock(state.mutex);
+            pending.swap(state.pending);
+            timeout = release_delayed(pending);
+        }
+
+        for (auto& [handle, done] : pending) {
+            if (CURLMcode res = curl_multi_add_handle(state.multi, handle); res != CURLM_OK) {
+                std::cerr << "curl_multi_add_handle() failed: " << curl_multi_strerror(res) << std::endl;
+                done(CURLE_FAILED_INIT);
+            } else state.active.emplace(handle, std::move(done));
+        }
+        return timeout;
+    }
+
+    static void complete_finished() {
+        int remaining = 0;
+        while (CURLMsg* message = curl_multi_info_read(state.multi, &remaining)) {
+            if (message->msg != CURLMSG_DONE) continue;
+
+            CURL* handle = message->easy_handle;
+            CURLcode result = message->data.result;
+            curl_multi_remove_handle(state.multi, handle);
+
+            auto node = state.active.extract(handle);
+            if (!node.empty()) node.mapped()(result);
+        }
+    }
+
+    static void run() {
+        while (state.running) {
+            int timeout = add_pending();
+
+            int still_running = 0;
+            if (CURLMcode res = curl_multi_perform(state.multi, &still_running); res != CURLM_OK)
+                std::cerr << "curl_multi_perform() failed: " << curl_multi_strerror(res) << std::endl;
+
+            complete_finished();
+            curl_multi_poll(state.multi, nullptr, 0, timeout, nullptr);
+        }
+    }
+
+public:
+    inline static long max_host_connections = 8, max_total_connections = 64, max_concurrent_streams = 100;
+    inline static int poll_timeout_ms = 1000;
+
+    // queue a configured easy handle; `done` runs on the loop thread after the handle left the multi handle
+    static void submit(CURL* handle, Completion done) {
+        start();
+        {
+            std::lock_guard lock(state.mutex);
+            state.pending.emplace_back(handle, std::move(done));
+        }
+        curl_multi_wakeup(state.multi);
+    }
+
+    // same as submit(), but the handle is only added once `delay` elapsed (retries with backoff)
+    static void submit_after(CURL* handle, Completion done, std::chrono::milliseconds delay) {
+        start();
+        {
+            std::lock_guard lock(state.mutex);
+            state.delayed.emplace_back(std::chrono::steady_clock::now() + delay, handle, std::move(done));
+        }
+        curl_multi_wakeup(state.multi);
+    }
+};
+
+#endif //FORTI_API_ASYNC_ENGINE_HPP
@@ -0,0 +1,154 @@
+#ifndef FORTI_API_BODY_HPP
+#define FORTI_API_BODY_HPP
+
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+#include <string>
+#include <string_view>
+#include "types/threat_feed/ext_connector.h"
+
+
+/*
+ * Request body produced piecewise straight into the buffer curl hands to CURLOPT_READFUNCTION, so a payload is never
+ * materialised as a JSON DOM or a full-size string.  Writers stage at most one token at a time in a reused buffer.
+ */
+class BodyWriter {
+protected:
+    std::string staged;
+    std::size_t staged_offset = 0;
+
+    // append the next piece of the document to `staged`; return false once the document is complete
+    virtual bool produce() = 0;
+
+    // start over from the first byte (curl may rewind on a resend); return false if the writer can't
+    virtual bool restart() = 0;
+
+    static void append_string(std::string& out, std::string_view value) {
+        static constexpr char hex[] = "0123456789abcdef";
+        out.push_back('"');
+        for (unsigned char c : value) {
+            switch (c) {
+                case '"': out += "\\\""; break;
+                case '\\': out += "\\\\"; break;
+                case '\n': out += "\\n"; break;
+                case '\r': out += "\\r"; break;
+                case '\t': out += "\\t"; break;
+                default:
+                    if (c < 0x20) {
+                        out += "\\u00";
+                        out.push_back(hex[c >> 4]);
+                        out.push_back(hex[c & 0x0F]);
+                    } else out.push_back(static_cast<char>(c));
+            }
+        }
+        out.push_back('"');
+    }
+
+public:
+    virtual ~BodyWriter() = default;
+
+    // fill up to `capacity` bytes of `buffer`; 0 means the body is complete
+    std::size_t read(char* buffer, std::size_t capacity) {
+        std::size_t written = 0;
+        while (written < capacity) {
+            if (staged_offset == staged.size()) {
+                staged.clear();
+                staged_offset = 0;
+                if (!produce() && staged.empty()) break;
+            }
+            std::size_t n = std::min(capacity - written, staged.size() - staged_offset);
+            std::memcpy(buffer + written, staged.data() + staged_offset, n);
+            staged_offset += n;
+            written += n;
+        }
+        return written;
+    }
+
+    bool rewind() {
+        staged.clear();
+        staged_offset = 0;
+        return restart();
+    }
+};
+
+
+// an already serialised document, served in slices
+class StringBodyWriter : public BodyWriter {
+    std::string_view body;
+    bool done = false;
+
+    bool produce() override {
+        if (done) return false;
+        staged.assign(body);
+        done = true;
+        return true;
+    }
+
+    bool restart() override {
+        done = false;
+        return true;
+    }
+
+public:
+    explicit StringBodyWriter(std::string_view body) : body(body) {}
+};
+
+
+// {"commands":[{"name":..,"command":..,"entries":[..]},..]} emitted one entry at a time
+class CommandsBodyWriter : public BodyWriter {
+    const CommandsRequest& request;
+    std::size_t command = 0, entry = 0;
+    enum class Stage { Open, CommandHead, Entries, Close, Done } stage = Stage::Open;
+
+    bool produce() override {
+        switch (stage) {
+            case Stage::Open:
+                staged += "{\"commands\":[";
+                stage = request.commands.empty() ? Stage::Close : Stage::CommandHead;
+                return true;
+            case Stage::CommandHead: {
+                const auto& current = request.commands[command];
+                if (command > 0) staged.push_back(',');
+                staged += "{\"name\":";
+                append_string(staged, current.name);
+                staged += ",\"command\":";
+                append_string(staged, current.command);
+                staged += ",\"entries\":[";
+                entry = 0;
+                stage = Stage::Entries;
+                return true;
+            }
+            case Stage::Entries: {
+                const auto& entries = request.commands[command].entries;
+                if (entry < entries.size()) {
+                    if (entry > 0) staged.push_back(',');
+                    append_string(staged, entries[entry++]);
+                    return true;
+                }
+                staged += "]}";
+                stage = ++command < request.commands.size() ? Stage::CommandHead : Stage::Close;
+                return true;
+            }
+            case Stage::Close:
+                staged += "]}";
+                stage = Stage::Done;
+                return true;
+            case Stage::Done:
+                return false;
+        }
+        return false;
+    }
+
+    bool restart() override {
+        command = 0;
+        entry = 0;
+        stage = Stage::Open;
+        return true;
+    }
+
+public:
+    explicit CommandsBodyWriter(const CommandsRequest& request) : request(request) {}
+};
+
+#endif //FORTI_API_BODY_HPP
@@ -0,0 +1,114 @@
+#ifndef FORTI_API_BULK_HPP
+#define FORTI_API_BULK_HPP
+
+#include <algorithm>
+#include <deque>
+#include <exception>
+#include <future>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include "api.hpp"
+
+
+struct BulkItemResult {
+    std::string object, error;
+    bool success{};
+};
+
+struct BulkResult {
+    std::vector<BulkItemResult> items;
+
+    [[nodiscard]] bool ok() const {
+        return std::all_of(items.begin(), items.end(), [](const BulkItemResult& item) { return item.success; });
+    }
+
+    [[nodiscard]] std::vector<std::string> succeeded() const { return objects(true); }
+    [[nodiscard]] std::vector<std::string> failed() const { return objects(false); }
+
+    void merge(BulkResult other) {
+        items.insert(items.end(), std::make_move_iterator(other.items.begin()), std::make_move_iterator(other.items.end()));
+    }
+
+private:
+    [[nodiscard]] std::vector<std::string> objects(bool success) const {
+        std::vector<std::string> result;
+        for (const auto& item : items) if (item.success == success) result.push_back(item.object);
+        return result;
+    }
+};
+
+
+/*
+ * Bounded fan-out over the AsyncEngine: at most `limit` requests are in flight at once and every object gets its
+ * own entry in the BulkResult, so one failing object never stops the rest of the batch.
+ */
+class Bulk {
+    template<typename Item, typename Name, typename Launch, typename Settle>
+    static BulkResult fan_out(const std::vector<Item>& items, Name name_of, Launch launch, Settle settle,
+                              std::size_t limit) {
+        using Future = std::invoke_result_t<Launch, const Item&>;
+
+        BulkResult result;
+        std::deque<std::pair<const Item*, Future>> window;
+
+        auto settle_front = [&] {
+            auto [item, future] = std::move(window.front());
+            window.pop_front();
+
+            BulkItemResult entry;
+            entry.object = name_of(*item);
+            try {
+                entry.error = settle(*item, future.get());
+                entry.success = entry.error.empty();
+            } catch (const std::exception& e) {
+                entry.error = e.what();
+            }
+            result.items.push_back(std::move(entry));
+        };
+
+        for (const auto& item : items) {
+            if (window.size() >= std::max<std::size_t>(limit, 1)) settle_front();
+            try {
+                window.emplace_back(&item, launch(item));
+            } catch (const std::exception& e) {
+                result.items.push_back({name_of(item), e.what()});
+            }
+        }
+        while (!window.empty()) settle_front();
+
+        return result;
+    }
+
+public:
+    inline static std::size_t max_concurrency = 8;
+
+    // write phase: launch(item) returns std::future<Response>; anything but status "success" counts as a failure
+    template<typename Item, typename Name, typename Launch>
+    static BulkResult apply(const std::vector<Item>& items, Name name_of, Launch launch,
+                            std::size_t limit = max_concurrency) {
+        return fan_out(items, name_of, launch, [](const Item&, const Response& response) -> std::string {
+            if (response.status == "success") return {};
+            return std::format("{} (http {})", response.status, response.http_status);
+        }, limit);
+    }
+
+    // read phase: objects that could be fetched are returned, objects that could not are recorded in `failures`
+    template<typename Item, typename Name, typename Launch>
+    static auto fetch(const std::vector<Item>& items, Name name_of, Launch launch, BulkResult& failures,
+                      std::size_t limit = max_concurrency) {
+        using T = decltype(std::declval<std::invoke_result_t<Launch, const Item&>>().get());
+
+        std::vector<T> fetched;
+        auto result = fan_out(items, name_of, launch, [&fetched](const Item&, T value) -> std::string {
+            fetched.push_back(std::move(value));
+            return {};
+        }, limit);
+
+        for (auto& item : result.items) if (!item.success) failures.items.push_back(std::move(item));
+        return fetched;
+    }
+};
+
+#endif //FORTI_API_BULK_HPP
@@ -0,0 +1,208 @@
+#ifndef FORTI_API_CACHE_HPP
+#define FORTI_API_CACHE_HPP
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <format>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <typeinfo>
+#include <unordered_map>
+#include <utility>
+
+
+/*
+ * Opt-in, typed read-through cache for CMDB GETs, keyed by decoded type + gateway + endpoint + vdom.
+ *
+ * Entries younger than `ttl` are served without touching the FortiGate.  Older entries are revalidated by FortiAPI
+ * with a tiny probe of the same endpoint: if the config `revision` FortiOS reports is unchanged the entry is reused,
+ * otherwise it is refetched.  Writes through FortiAPI::put/post/del drop every entry of the table they touched once
+ * they complete (threat feed pushes to the monitor API count as writes to /cmdb/system/external-resource), and a read
+ * that was already in flight when an invalidation happened is not stored.
+ * The least recently used entry is evicted once `max_entries` is reached.
+ */
+class CmdbCache {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    struct Stats {
+        unsigned long long hits{}, misses{}, revalidations{}, invalidations{}, evictions{};
+    };
+
+    template<typename T>
+    struct Lookup {
+        std::shared_ptr<const T> value;
+        std::string revision;
+        bool fresh{};
+    };
+
+private:
+    struct Entry {
+        std::shared_ptr<const void> value;
+        std::string gateway, table, vdom, revision;
+        Clock::time_point fetched;
+        std::list<std::string>::iterator recency;
+    };
+
+    inline static std::mutex mutex;
+    inline static std::unordered_map<std::string, Entry> entries;
+    inline static std::list<std::string> recency;  // most recently used first
+    inline static std::atomic<bool> active{false};
+    inline static Clock::duration ttl = std::chrono::seconds(30);
+    inline static std::size_t max_entries = 256;
+    inline static std::atomic<unsigned long long> hits{0}, misses{0}, revalidations{0}, invalidations{0}, evictions{0};
+    inline static std::atomic<unsigned long long> writes{0};  // invalidate() calls so far
+
+    // monitor endpoints whose POSTs change a CMDB table that is read (and cached) under its own path
+    inline static const std::unordered_map<std::string, std::string> monitor_writes = {
+            {"/monitor/system/external-resource", "/cmdb/system/external-resource"},  // threat feed pushes
+    };
+
+    // "/cmdb/firewall/policy/12?vdom=root" -> table "/cmdb/firewall/policy", vdom "root"
+    static std::pair<std::string, std::string> split(std::string_view path) {
+        auto query_start = path.find('?');
+        auto resource = path.substr(0, query_start);
+
+        std::size_t end = 0;
+        for (int segments = 0; segments < 3 && end != std::string_view::npos; ++segments)
+            end = resource.find('/', end + 1);
+
+        std::string vdom;
+        if (query_start != std::string_view::npos) {
+            auto query = path.substr(query_start + 1);
+            for (std::size_t pos = 0; pos < query.size();) {
+                auto next = query.find('&', pos);
+                auto param = query.substr(pos, next == std::string_view::npos ? query.size() - pos : next - pos);
+                if (param.starts_with("vdom=")) vdom = param.substr(5);
+                if (next == std::string_view::npos) break;
+                pos = next + 1;
+            }
+        }
+
+        return {std::string(resource.substr(0, end)), vdom};
+    }
+
+    template<typename T>
+    static std::string key(std::string_view gateway, const std::string& path) {
+        return std::format("{} {} {}", typeid(T).name(), gateway, path);
+    }
+
+    static void touch(Entry& entry, const std::string& key) {
+        recency.erase(entry.recency);
+        recency.push_front(key);
+        entry.recency = recency.begin();
+    }
+
+    static void erase(std::unordered_map<std::string, Entry>::iterator it) {
+        recency.erase(it->second.recency);
+        entries.erase(it);
+    }
+
+public:
+    static void enable(Clock::duration time_to_live = std::chrono::seconds(30), std::size_t entry_limit = 256) {
+        std::lock_guard lock(mutex);
+        ttl = time_to_live;
+        max_entries = entry_limit;
+        active = true;
+    }
+
+    static void disable() {
+        active = false;
+        clear();
+    }
+
+    [[nodiscard]] static bool enabled() { return active.load(std::memory_order_relaxed); }
+
+    static bool cacheable(std::string_view path) { return enabled() && path.starts_with("/cmdb/"); }
+
+    template<typename T>
+    static Lookup<T> lookup(std::string_view gateway, const std::string& path) {
+        auto id = key<T>(gateway, path);
+        std::lock_guard lock(mutex);
+
+        auto it = entries.find(id);
+        if (it == entries.end()) {
+            misses.fetch_add(1, std::memory_order_relaxed);
+            return {};
+        }
+
+        touch(it->second, id);
+        bool fresh = Clock::now() - it->second.fetched < ttl;
+        if (fresh) hits.fetch_add(1, std::memory_order_relaxed);
+        return {std::static_pointer_cast<const T>(it->second.value), it->second.revision, fresh};
+    }
+
+    // take before fetching and hand to store(), which then drops the value if a write completed in between
+    [[nodiscard]] static unsigned long long generation() { return writes.load(); }
+
+    template<typename T>
+    static void store(std::string_view gateway, const std::string& path, const T& value, const std::string& revision,
+                      unsigned long long fetched_generation) {
+        auto id = key<T>(gateway, path);
+        auto [table, vdom] = split(path);
+        std::lock_guard lock(mutex);
+        if (writes.load() != fetched_generation) return;
+
+        if (auto it = entries.find(id); it != entries.end()) erase(it);
+        while (!entries.empty() && entries.size() >= max_entries) {
+            erase(entries.find(recency.back()));
+            evictions.fetch_add(1, std::memory_order_relaxed);
+        }
+        if (max_entries == 0) return;
+
+        recency.push_front(id);
+        entries.emplace(id, Entry{std::make_shared<const T>(value), std::string(gateway), std::move(table),
+                                  std::move(vdom), revision, Clock::now(), recency.begin()});
+    }
+
+    // the probe confirmed the entry is still current: restart its TTL
+    template<typename T>
+    static void revalidated(std::string_view gateway, const std::string& path) {
+        std::lock_guard lock(mutex);
+        if (auto it = entries.find(key<T>(gateway, path)); it != entries.end()) {
+            it->second.fetched = Clock::now();
+            revalidations.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+
+    // a stale entry whose revision changed: it will be refetched
+    static void record_miss() { misses.fetch_add(1, std::memory_order_relaxed); }
+
+    // a write to `path` drops every cached read of the same table on that gateway (in the same vdom, or in all if none
+    // was given)
+    static void invalidate(std::string_view gateway, std::string_view path) {
+        if (!enabled()) return;
+        auto [table, vdom] = split(path);
+        if (auto it = monitor_writes.find(table); it != monitor_writes.end()) table = it->second;
+        std::lock_guard lock(mutex);
+        writes.fetch_add(1);
+
+        for (auto it = entries.begin(); it != entries.end();) {
+            auto current = it++;
+            const auto& entry = current->second;
+            if (entry.gateway == gateway && entry.table == table &&
+                (vdom.empty() || entry.vdom.empty() || entry.vdom == vdom)) {
+                erase(current);
+                invalidations.fetch_add(1, std::memory_order_relaxed);
+            }
+        }
+    }
+
+    static void clear() {
+        std::lock_guard lock(mutex);
+        entries.clear();
+        recency.clear();
+    }
+
+    static Stats stats() {
+        return {hits.load(std::memory_order_relaxed), misses.load(std::memory_order_relaxed),
+                revalidations.load(std::memory_order_relaxed), invalidations.load(std::memory_order_relaxed),
+                evictions.load(std::memory_order_relaxed)};
+    }
+};
+
+#endif //FORTI_API_CACHE_HPP
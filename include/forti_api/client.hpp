@@ -0,0 +1,191 @@
+#ifndef FORTI_API_CLIENT_HPP
+#define FORTI_API_CLIENT_HPP
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <exception>
+#include <format>
+#include <fstream>
+#include <functional>
+#include <iterator>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <variant>
+#include <vector>
+
+
+// where and how to reach one FortiGate
+struct ClientConfig {
+    std::string gateway_ip{};
+    unsigned int admin_https_port = 443;
+    std::string ca_cert_path{}, ssl_cert_path{}, cert_password{}, api_key{};
+
+    [[nodiscard]] std::string gateway() const { return std::format("{}:{}", gateway_ip, admin_https_port); }
+
+    bool operator==(const ClientConfig&) const = default;
+};
+
+/*
+ * Immutable view of a ClientConfig as requests consume it, published by atomic pointer swap (RCU style): a reload
+ * builds a new snapshot and swaps it in, transfers already running keep the one they started with alive, and the
+ * request path only ever does an atomic load.  Derived strings are computed once per reload and the P12 client
+ * certificate is read on first use, so a certificate rotated in place is picked up by the next reload.
+ */
+class ConfigSnapshot {
+    mutable std::once_flag certificate_loaded;
+    mutable std::shared_ptr<const std::string> certificate_bytes;
+
+public:
+    const ClientConfig config;
+    const std::string gateway, base_url, auth_header;
+
+    explicit ConfigSnapshot(ClientConfig settings)
+            : config(std::move(settings)),
+              gateway(config.gateway()),
+              base_url(std::format("https://{}/api/v2", gateway)),
+              auth_header(config.api_key.empty() ? std::string() : "Authorization: Bearer " + config.api_key) {}
+
+    // the P12 bundle at config.ssl_cert_path, nullptr when no client certificate is configured
+    [[nodiscard]] std::shared_ptr<const std::string> certificate() const {
+        if (config.ssl_cert_path.empty()) return nullptr;
+        std::call_once(certificate_loaded, [this] {
+            std::ifstream file(config.ssl_cert_path, std::ios::binary);
+            if (!file) return;
+            certificate_bytes = std::make_shared<const std::string>(std::istreambuf_iterator<char>(file),
+                                                                    std::istreambuf_iterator<char>());
+        });
+        if (!certificate_bytes) throw std::runtime_error("Unable to read client certificate: " + config.ssl_cert_path);
+        return certificate_bytes;
+    }
+};
+
+/*
+ * One FortiGate with its own credentials.  Every accessor (FortiGate::Policies, DNSFilter, ThreatFeed, System, ...)
+ * talks to the client that is active on the calling thread, falling back to the process-wide FortiAuth settings:
+ *
+ *     FortiClient branch({.gateway_ip = "10.1.0.1", .ca_cert_path = "branch-ca.pem", .api_key = key});
+ *     auto policies = branch.run([] { return FortiGate::Policies::get(); });
+ *
+ * Connections, throttle limits and caches are kept per gateway, so clients never share a socket or a cached table.
+ * Async calls bind to the client active when they are issued; lazily evaluated ranges (Paginated) should be consumed
+ * inside run().  Copies share their configuration, so reload() on any of them rotates credentials for all.
+ */
+class FortiClient {
+    struct State {
+        std::string label;
+        std::atomic<std::shared_ptr<const ConfigSnapshot>> settings;
+    };
+
+    std::shared_ptr<State> state;
+
+    inline static thread_local const FortiClient* active = nullptr;
+
+public:
+    explicit FortiClient(ClientConfig config, std::string name = "") : state(std::make_shared<State>()) {
+        state->label = name.empty() ? config.gateway() : std::move(name);
+        state->settings.store(std::make_shared<const ConfigSnapshot>(std::move(config)));
+    }
+
+    [[nodiscard]] const std::string& name() const { return state->label; }
+
+    [[nodiscard]] std::shared_ptr<const ConfigSnapshot> config() const { return state->settings.load(); }
+
+    // requests issued from now on use `config`; those already in flight finish with the previous one
+    void reload(ClientConfig config) const {
+        state->settings.store(std::make_shared<const ConfigSnapshot>(std::move(config)));
+    }
+
+    // makes `client` the active one on this thread until destroyed (scopes nest)
+    class Scope {
+        const FortiClient* previous;
+
+    public:
+        explicit Scope(const FortiClient& client) : previous(std::exchange(active, &client)) {}
+        Scope(const Scope&) = delete;
+        Scope& operator=(const Scope&) = delete;
+        ~Scope() { active = previous; }
+    };
+
+    template<typename F>
+    decltype(auto) run(F&& fn) const {
+        Scope scope(*this);
+        return std::invoke(std::forward<F>(fn));
+    }
+
+    // the client active on this thread, nullptr when FortiAuth's settings apply
+    [[nodiscard]] static const FortiClient* current() { return active; }
+};
+
+
+// outcome of one client's share of a Fleet::run
+template<typename T>
+struct DeviceResult {
+    std::string client;
+    std::optional<T> value;
+    std::exception_ptr error;
+
+    [[nodiscard]] bool ok() const { return !error; }
+
+    // the value, or the exception the operation threw on this device
+    const T& get() const {
+        if (error) std::rethrow_exception(error);
+        return *value;
+    }
+};
+
+/*
+ * Runs the same operation against many FortiGates in parallel, `parallelism` devices at a time, and returns one
+ * DeviceResult per client in the order the clients were given.  A failing device never aborts the others.
+ *
+ *     Fleet fleet(clients, 32);
+ *     auto counts = fleet.run([](const FortiClient&) { return FortiGate::Policies::get().size(); });
+ */
+class Fleet {
+    std::vector<FortiClient> clients;
+    std::size_t parallelism;
+
+public:
+    explicit Fleet(std::vector<FortiClient> clients, std::size_t parallelism = 16)
+            : clients(std::move(clients)), parallelism(std::max<std::size_t>(1, parallelism)) {}
+
+    [[nodiscard]] const std::vector<FortiClient>& members() const { return clients; }
+
+    template<typename F,
+             typename R = std::invoke_result_t<F&, const FortiClient&>,
+             typename T = std::conditional_t<std::is_void_v<R>, std::monostate, R>>
+    std::vector<DeviceResult<T>> run(F fn) const {
+        std::vector<DeviceResult<T>> results(clients.size());
+        std::atomic<std::size_t> next{0};
+
+        auto worker = [&] {
+            for (std::size_t i; (i = next.fetch_add(1)) < clients.size();) {
+                const auto& client = clients[i];
+                results[i].client = client.name();
+                try {
+                    FortiClient::Scope scope(client);
+                    if constexpr (std::is_void_v<R>) {
+                        fn(client);
+                        results[i].value.emplace();
+                    } else results[i].value.emplace(fn(client));
+                } catch (...) {
+                    results[i].error = std::current_exception();
+                }
+            }
+        };
+
+        std::vector<std::jthread> workers;
+        for (std::size_t i = 1; i < std::min(parallelism, clients.size()); ++i) workers.emplace_back(worker);
+        worker();
+        workers.clear();  // joins
+        return results;
+    }
+};
+
+#endif //FORTI_API_CLIENT_HPP
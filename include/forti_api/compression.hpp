@@ -0,0 +1,144 @@
+#ifndef FORTI_API_COMPRESSION_HPP
+#define FORTI_API_COMPRESSION_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <iostream>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <unordered_set>
+#include <zlib.h>
+#include "body.hpp"
+
+
+/*
+ * Content-Encoding for FortiGate traffic, which is repetitive JSON that gzip shrinks several times over.
+ *
+ * Responses: with `accept_responses` set, every request offers the encodings libcurl was built with and curl inflates
+ * the answer while it streams in, so callers always see plain JSON.  Requests: bodies of at least `request_threshold`
+ * bytes (0 disables) are sent gzip-encoded; streamed BodyWriter bodies, whose size is unknown, are deflated on the fly
+ * whenever it is non-zero.  Not every FortiOS build accepts an encoded request body: a gateway that answers one with
+ * 415 Unsupported Media Type gets that request resent plain, and plain bodies from then on.
+ */
+class Compression {
+    inline static std::mutex mutex;
+    inline static std::unordered_set<std::string> declined;  // gateways that refused an encoded request body
+
+public:
+    // read by every request, the AsyncEngine loop included, so they can be changed while traffic is in flight
+    inline static std::atomic<bool> accept_responses = true;
+    inline static std::atomic<std::size_t> request_threshold = 0;
+    inline static std::atomic<int> level = Z_DEFAULT_COMPRESSION;
+
+    // true when a request body of `size` bytes to `gateway` should be gzip-encoded
+    static bool compress_request(const std::string& gateway, std::size_t size) {
+        auto threshold = request_threshold.load(std::memory_order_relaxed);
+        if (threshold == 0 || size < threshold) return false;
+        std::lock_guard lock(mutex);
+        return !declined.contains(gateway);
+    }
+
+    static void decline(const std::string& gateway) {
+        std::lock_guard lock(mutex);
+        if (declined.insert(gateway).second)
+            std::cerr << "[WARNING] " << gateway << " does not accept compressed request bodies, sending them plain\n";
+    }
+
+    static void clear() {
+        std::lock_guard lock(mutex);
+        declined.clear();
+    }
+
+    static std::string gzip(std::string_view data) {
+        z_stream stream{};
+        if (deflateInit2(&stream, level, Z_DEFLATED, 15 + 16, 8, Z_DEFAULT_STRATEGY) != Z_OK)
+            throw std::runtime_error("deflateInit2() failed");
+
+        std::string out(deflateBound(&stream, static_cast<uLong>(data.size())), '\0');
+        stream.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(data.data()));
+        stream.avail_in = static_cast<uInt>(data.size());
+        stream.next_out = reinterpret_cast<Bytef*>(out.data());
+        stream.avail_out = static_cast<uInt>(out.size());
+        int result = deflate(&stream, Z_FINISH);
+        out.resize(stream.total_out);
+        deflateEnd(&stream);
+        if (result != Z_STREAM_END) throw std::runtime_error("gzip compression failed");
+        return out;
+    }
+
+    // gzip or zlib (deflate) encoded data, detected from the header
+    static std::string inflate(std::string_view data) {
+        z_stream stream{};
+        if (inflateInit2(&stream, 15 + 32) != Z_OK) throw std::runtime_error("inflateInit2() failed");
+
+        std::string out;
+        char chunk[16384];
+        stream.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(data.data()));
+        stream.avail_in = static_cast<uInt>(data.size());
+        int result;
+        do {
+            stream.next_out = reinterpret_cast<Bytef*>(chunk);
+            stream.avail_out = sizeof(chunk);
+            result = ::inflate(&stream, Z_NO_FLUSH);
+            out.append(chunk, sizeof(chunk) - stream.avail_out);
+        } while (result == Z_OK);
+        inflateEnd(&stream);
+        if (result != Z_STREAM_END) throw std::runtime_error("Malformed compressed body");
+        return out;
+    }
+};
+
+
+// gzip-encodes another writer's document as curl pulls it, one source chunk at a time
+class GzipBodyWriter : public BodyWriter {
+    static constexpr std::size_t chunk_size = 16 * 1024;
+
+    BodyWriter& source;
+    z_stream stream{};
+    std::string input;
+    bool finished = false;
+
+    bool produce() override {
+        if (finished) return false;
+        input.resize(chunk_size);
+        auto taken = source.read(input.data(), input.size());
+        int flush = taken == 0 ? Z_FINISH : Z_NO_FLUSH;
+        stream.next_in = reinterpret_cast<Bytef*>(input.data());
+        stream.avail_in = static_cast<uInt>(taken);
+
+        int result;
+        do {  // deflate until it stops filling the output, i.e. it has consumed everything it was given
+            auto used = staged.size();
+            staged.resize(used + chunk_size);
+            stream.next_out = reinterpret_cast<Bytef*>(staged.data() + used);
+            stream.avail_out = static_cast<uInt>(chunk_size);
+            result = deflate(&stream, flush);
+            if (result == Z_STREAM_ERROR) throw std::runtime_error("gzip compression failed");
+            staged.resize(used + chunk_size - stream.avail_out);
+        } while (stream.avail_out == 0);
+
+        finished = result == Z_STREAM_END;
+        return true;
+    }
+
+    bool restart() override {
+        if (!source.rewind()) return false;
+        finished = false;
+        return deflateReset(&stream) == Z_OK;
+    }
+
+public:
+    explicit GzipBodyWriter(BodyWriter& source) : source(source) {
+        if (deflateInit2(&stream, Compression::level, Z_DEFLATED, 15 + 16, 8, Z_DEFAULT_STRATEGY) != Z_OK)
+            throw std::runtime_error("deflateInit2() failed");
+    }
+
+    GzipBodyWriter(const GzipBodyWriter&) = delete;
+    GzipBodyWriter& operator=(const GzipBodyWriter&) = delete;
+
+    ~GzipBodyWriter() override { deflateEnd(&stream); }
+};
+
+#endif //FORTI_API_COMPRESSION_HPP
@@ -0,0 +1,130 @@
+#ifndef FORTI_API_CONFIG_WATCHER_HPP
+#define FORTI_API_CONFIG_WATCHER_HPP
+
+#include <array>
+#include <chrono>
+#include <condition_variable>
+#include <filesystem>
+#include <format>
+#include <fstream>
+#include <iostream>
+#include <mutex>
+#include <optional>
+#include <stdexcept>
+#include <stop_token>
+#include <string>
+#include <system_error>
+#include <thread>
+#include <nlohmann/json.hpp>
+#include "api.hpp"
+#include "client.hpp"
+
+NLOHMANN_DEFINE_TYPE_NON_INTRUSIVE_WITH_DEFAULT(ClientConfig, gateway_ip, admin_https_port, ca_cert_path,
+                                                ssl_cert_path, cert_password, api_key)
+
+/*
+ * Reloads a FortiClient (or the FortiAuth defaults) when its settings change on disk or in the environment.
+ *
+ * The source is either a JSON file holding a ClientConfig ({"gateway_ip": ..., "api_key": ...}) or the FORTIGATE_*
+ * environment variables, of which the gateway, port and API key must be set.  Besides the settings themselves, the
+ * modification times of the config file and of the CA and client certificates are compared, so a certificate rotated
+ * in place is reloaded too.  A source that cannot be read or parsed is reported once and the previous configuration
+ * stays in effect.
+ *
+ *     ConfigWatcher watcher("/etc/forti/branch.json", branch);
+ *     watcher.start(std::chrono::seconds(5));
+ */
+class ConfigWatcher {
+public:
+    using Clock = std::chrono::steady_clock;
+
+private:
+    using Stamps = std::array<std::filesystem::file_time_type, 3>;  // config file, CA, client certificate
+
+    std::optional<std::filesystem::path> file;  // nullopt: the environment
+    std::optional<FortiClient> client;          // nullopt: FortiAuth
+    std::mutex mutex;
+    std::optional<ClientConfig> loaded;
+    Stamps stamps{};
+    std::string last_error;
+
+    std::mutex sleep_mutex;
+    std::condition_variable_any wake;
+    std::jthread poller;
+
+    static std::filesystem::file_time_type modified(const std::string& path) {
+        std::error_code error;
+        if (path.empty()) return {};
+        auto time = std::filesystem::last_write_time(path, error);
+        return error ? std::filesystem::file_time_type{} : time;
+    }
+
+    ClientConfig read() const {
+        if (!file) return FortiAuth::config_from_env(true);  // check() reports a missing variable, once
+        std::ifstream in(*file);
+        if (!in) throw std::runtime_error("Unable to open config file: " + file->string());
+        return nlohmann::json::parse(in).get<ClientConfig>();
+    }
+
+    void publish(ClientConfig config) const {
+        if (client) client->reload(std::move(config));
+        else FortiAuth::configure(std::move(config));
+    }
+
+public:
+    // watches the FORTIGATE_* environment variables
+    explicit ConfigWatcher(std::optional<FortiClient> client = std::nullopt) : client(std::move(client)) {}
+
+    // watches a JSON config file
+    explicit ConfigWatcher(std::filesystem::path file, std::optional<FortiClient> client = std::nullopt)
+            : file(std::move(file)), client(std::move(client)) {}
+
+    ConfigWatcher(const ConfigWatcher&) = delete;
+    ConfigWatcher& operator=(const ConfigWatcher&) = delete;
+
+    ~ConfigWatcher() { stop(); }
+
+    // rereads the source and publishes it when anything changed; true when a new snapshot was published
+    bool check() {
+        std::lock_guard lock(mutex);
+        try {
+            Stamps now{file ? modified(file->string()) : std::filesystem::file_time_type{}};
+            auto config = read();
+            now[1] = modified(config.ca_cert_path);
+            now[2] = modified(config.ssl_cert_path);
+            last_error.clear();
+
+            if (loaded && *loaded == config && stamps == now) return false;
+            publish(config);
+            loaded = std::move(config);
+            stamps = now;
+            return true;
+        } catch (const std::exception& e) {
+            if (last_error != e.what()) {
+                last_error = e.what();
+                std::cerr << "[WARNING] Config reload failed, keeping the previous configuration: " << e.what() << "\n";
+            }
+            return false;
+        }
+    }
+
+    // polls every `interval` on a background thread until stop() (the first check runs immediately)
+    void start(Clock::duration interval) {
+        stop();
+        poller = std::jthread([this, interval](std::stop_token stop) {
+            while (!stop.stop_requested()) {
+                check();
+                std::unique_lock lock(sleep_mutex);
+                wake.wait_for(lock, stop, interval, [] { return false; });
+            }
+        });
+    }
+
+    void stop() {
+        if (!poller.joinable()) return;
+        poller.request_stop();
+        poller.join();
+    }
+};
+
+#endif //FORTI_API_CONFIG_WATCHER_HPP
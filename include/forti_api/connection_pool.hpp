@@ -0,0 +1,195 @@
+#ifndef FORTI_API_CONNECTION_POOL_HPP
+#define FORTI_API_CONNECTION_POOL_HPP
+
+#include <curl/curl.h>
+#include <array>
+#include <atomic>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+
+/*
+ * Process-wide pool of warm libcurl easy handles, keyed by gateway ("host:port").
+ *
+ * Every handle is attached to one CURLSH so the DNS cache and TLS session cache are shared between all handles and
+ * threads.  Connections are not shared through it: libcurl does not support one connection cache being used by
+ * transfers running concurrently on different threads.  Instead each pooled handle keeps its own connections across
+ * curl_easy_reset() when it is returned, so the next request to the same gateway skips the TCP + TLS handshake, and
+ * the AsyncEngine's multi handle keeps its own cache for the transfers it drives.
+ *
+ * With `http2` set, transfers offer HTTP/2 through ALPN and wait for an existing connection to the gateway rather than
+ * opening another one, so concurrent requests on the AsyncEngine share a single TLS session as multiplexed streams.
+ * A gateway that answers with HTTP/1.1 is remembered and served from the plain HTTP/1.1 pool from then on.
+ */
+class ConnectionPool {
+public:
+    struct Stats {
+        unsigned long long requests{}, new_connections{}, reused_connections{}, http2_requests{};
+
+        [[nodiscard]] double reuse_ratio() const {
+            return requests == 0 ? 0.0 : static_cast<double>(reused_connections) / static_cast<double>(requests);
+        }
+    };
+
+    class Lease {
+        CURL* handle = nullptr;
+        std::string gateway;
+
+    public:
+        Lease(CURL* handle, std::string gateway) : handle(handle), gateway(std::move(gateway)) {}
+        Lease(const Lease&) = delete;
+        Lease& operator=(const Lease&) = delete;
+        Lease(Lease&& other) noexcept : handle(std::exchange(other.handle, nullptr)), gateway(std::move(other.gateway)) {}
+        ~Lease() { if (handle) release(gateway, handle); }
+
+        [[nodiscard]] CURL* get() const { return handle; }
+
+        // call once per completed transfer so the reuse counters stay accurate
+        void record() const { ConnectionPool::record(gateway, handle); }
+
+        // options that curl_easy_reset() clears but which every pooled transfer needs
+        void apply_connection_options() const { ConnectionPool::apply_connection_options(handle, gateway); }
+    };
+
+private:
+    struct State {
+        CURLSH* share = nullptr;
+        std::array<std::mutex, CURL_LOCK_DATA_LAST> share_locks{};
+        std::mutex mutex;
+        std::unordered_map<std::string, std::vector<CURL*>> idle;
+        std::unordered_set<std::string> http1_only;  // gateways that declined HTTP/2
+
+        State() {
+            curl_global_init(CURL_GLOBAL_DEFAULT);
+            share = curl_share_init();
+            curl_share_setopt(share, CURLSHOPT_LOCKFUNC, lock);
+            curl_share_setopt(share, CURLSHOPT_UNLOCKFUNC, unlock);
+            curl_share_setopt(share, CURLSHOPT_USERDATA, this);
+            curl_share_setopt(share, CURLSHOPT_SHARE, CURL_LOCK_DATA_DNS);
+            curl_share_setopt(share, CURLSHOPT_SHARE, CURL_LOCK_DATA_SSL_SESSION);
+        }
+
+        ~State() {
+            for (auto& [gateway, handles] : idle) for (auto* handle : handles) curl_easy_cleanup(handle);
+            curl_share_cleanup(share);
+        }
+
+        static void lock(CURL*, curl_lock_data data, curl_lock_access, void* userptr) {
+            static_cast<State*>(userptr)->share_locks[data].lock();
+        }
+
+        static void unlock(CURL*, curl_lock_data data, void* userptr) {
+            static_cast<State*>(userptr)->share_locks[data].unlock();
+        }
+    };
+
+    inline static State state;
+    inline static std::atomic<unsigned long long> requests{0}, new_connections{0}, reused_connections{0},
+                                                  http2_requests{0};
+
+    static void release(const std::string& gateway, CURL* handle) {
+        curl_easy_reset(handle);
+        std::lock_guard lock(state.mutex);
+        auto& handles = state.idle[gateway];
+        if (handles.size() < max_idle_per_gateway) handles.push_back(handle);
+        else curl_easy_cleanup(handle);
+    }
+
+    static void record(const std::string& gateway, CURL* handle) {
+        long connects = 0, version = 0;
+        curl_easy_getinfo(handle, CURLINFO_NUM_CONNECTS, &connects);
+        curl_easy_getinfo(handle, CURLINFO_HTTP_VERSION, &version);
+        requests.fetch_add(1, std::memory_order_relaxed);
+        if (connects > 0) new_connections.fetch_add(1, std::memory_order_relaxed);
+        else reused_connections.fetch_add(1, std::memory_order_relaxed);
+
+        // only a freshly negotiated connection tells whether the gateway speaks HTTP/2 (a reused one may predate it)
+        if (version == CURL_HTTP_VERSION_2_0) http2_requests.fetch_add(1, std::memory_order_relaxed);
+        else if (http2 && connects > 0 && version != 0) {
+            std::lock_guard lock(state.mutex);
+            if (state.http1_only.insert(gateway).second)
+                std::cerr << "[WARNING] " << gateway << " does not speak HTTP/2, falling back to HTTP/1.1\n";
+        }
+    }
+
+    static void apply_connection_options(CURL* handle, const std::string& gateway) {
+        curl_easy_setopt(handle, CURLOPT_SHARE, state.share);
+        curl_easy_setopt(handle, CURLOPT_SSL_SESSIONID_CACHE, 1L);
+        curl_easy_setopt(handle, CURLOPT_FORBID_REUSE, 0L);
+        curl_easy_setopt(handle, CURLOPT_FRESH_CONNECT, 0L);
+        curl_easy_setopt(handle, CURLOPT_DNS_CACHE_TIMEOUT, -1L);
+        curl_easy_setopt(handle, CURLOPT_TCP_KEEPALIVE, 1L);
+        curl_easy_setopt(handle, CURLOPT_TCP_KEEPIDLE, keepalive_idle_seconds);
+        curl_easy_setopt(handle, CURLOPT_TCP_KEEPINTVL, keepalive_interval_seconds);
+        curl_easy_setopt(handle, CURLOPT_MAXAGE_CONN, max_connection_age_seconds);
+        // bounds the connections a handle keeps open between transfers (gateways it has talked to since its last reset)
+        curl_easy_setopt(handle, CURLOPT_MAXCONNECTS, max_cached_connections);
+
+        if (multiplexed(gateway)) {
+            curl_easy_setopt(handle, CURLOPT_HTTP_VERSION, CURL_HTTP_VERSION_2TLS);
+            curl_easy_setopt(handle, CURLOPT_PIPEWAIT, 1L);
+        } else curl_easy_setopt(handle, CURLOPT_HTTP_VERSION, CURL_HTTP_VERSION_1_1);
+    }
+
+public:
+    inline static std::size_t max_idle_per_gateway = 16;
+    // negotiate HTTP/2 and multiplex concurrent requests per gateway (falls back to HTTP/1.1 per gateway)
+    inline static std::atomic<bool> http2 = false;
+    inline static long keepalive_idle_seconds = 30, keepalive_interval_seconds = 15, max_connection_age_seconds = 300;
+    inline static long max_cached_connections = 64;
+
+    // hand out a warm handle for the gateway, or a fresh one wired to the shared DNS/TLS caches
+    static Lease acquire(const std::string& gateway) {
+        {
+            std::lock_guard lock(state.mutex);
+            auto& handles = state.idle[gateway];
+            if (!handles.empty()) {
+                CURL* handle = handles.back();
+                handles.pop_back();
+                return {handle, gateway};
+            }
+        }
+
+        CURL* handle = curl_easy_init();
+        if (!handle) throw std::runtime_error("curl_easy_init() failed for gateway: " + gateway);
+        return {handle, gateway};
+    }
+
+    // true while requests to `gateway` are sent as HTTP/2 streams
+    static bool multiplexed(const std::string& gateway) {
+        if (!http2) return false;
+        std::lock_guard lock(state.mutex);
+        return !state.http1_only.contains(gateway);
+    }
+
+    // drop idle handles (and with them their connections) and forget which gateways declined HTTP/2
+    static void clear() {
+        std::lock_guard lock(state.mutex);
+        for (auto& [gateway, handles] : state.idle) for (auto* handle : handles) curl_easy_cleanup(handle);
+        state.idle.clear();
+        state.http1_only.clear();
+    }
+
+    static Stats stats() {
+        return {requests.load(std::memory_order_relaxed),
+                new_connections.load(std::memory_order_relaxed),
+                reused_connections.load(std::memory_order_relaxed),
+                http2_requests.load(std::memory_order_relaxed)};
+    }
+
+    static void reset_stats() {
+        requests = 0;
+        new_connections = 0;
+        reused_connections = 0;
+        http2_requests = 0;
+    }
+};
+
+#endif //FORTI_API_CONNECTION_POOL_HPP
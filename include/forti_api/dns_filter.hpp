@@ -5,15 +5,165 @@
 #ifndef FORTI_API_DNS_FILTER_HPP
 #define FORTI_API_DNS_FILTER_HPP
 
+#include <future>
+#include <string>
+#include <unordered_map>
 #include <utility>
+#include <vector>
 #include "api.hpp"
+#include "bulk.hpp"
+#include "paginated.hpp"
+#include "query.hpp"
 #include "types/dns/filter.h"
+#include "types/wire.h"
+
+
+// what a DNSFilter::Plan sends for one profile
+struct DNSProfileChange {
+    std::string profile;
+    DNSFilterOptions::Categories blocked, monitored, allowed, unfiltered;  // categories that newly take each action
+    nlohmann::json patch;  // body of the partial PUT
+};
 
 
 class DNSFilter {
     inline static std::string api_endpoint = "/cmdb/dnsfilter/profile";
 
 public:
+    /*
+     * Batch of edits over profiles fetched once.  Changes are applied locally, changes() / report() show what would
+     * be sent (a dry run), and apply() PUTs only the profiles that differ from what was fetched, each with just the
+     * changed attributes and without existence checks.
+     *
+     *     auto plan = DNSFilter::plan();
+     *     plan.block(DNSFilterOptions::categories_of({26, 61, 86})).allow(52);
+     *     std::cout << plan.report();
+     *     plan.apply();
+     */
+    class Plan {
+        std::vector<DNSProfile> originals, profiles;
+        std::vector<bool> edited;  // touched by edit(), so attributes besides ftgd_dns may differ
+
+        [[nodiscard]] nlohmann::json patch(std::size_t i) const {
+            if (edited[i]) return Wire::diff(nlohmann::json(originals[i]), nlohmann::json(profiles[i]));
+            nlohmann::json patch = nlohmann::json::object();
+            if (!(profiles[i].ftgd_dns == originals[i].ftgd_dns))
+                patch[std::string(DNSProfile::wire_key(&DNSProfile::ftgd_dns))] = profiles[i].ftgd_dns;
+            return patch;
+        }
+
+        static std::string list(const DNSFilterOptions::Categories& categories) {
+            std::string out;
+            for (unsigned int category = 0; category < categories.size(); ++category)
+                if (categories.test(category)) out += std::format("{}{}", out.empty() ? "" : " ", category);
+            return out;
+        }
+
+    public:
+        explicit Plan(std::vector<DNSProfile> fetched)
+                : originals(fetched), profiles(std::move(fetched)), edited(profiles.size()) {}
+
+        [[nodiscard]] const std::vector<DNSProfile>& planned() const { return profiles; }
+
+        // category edits apply to every profile in the plan
+        Plan& block(const DNSFilterOptions::Categories& categories) {
+            for (auto& profile : profiles) profile.ftgd_dns.block(categories);
+            return *this;
+        }
+
+        Plan& monitor(const DNSFilterOptions::Categories& categories) {
+            for (auto& profile : profiles) profile.ftgd_dns.monitor(categories);
+            return *this;
+        }
+
+        Plan& allow(const DNSFilterOptions::Categories& categories) {
+            for (auto& profile : profiles) profile.ftgd_dns.allow(categories);
+            return *this;
+        }
+
+        Plan& block(unsigned int category) { return block(DNSFilterOptions::categories_of({category})); }
+        Plan& monitor(unsigned int category) { return monitor(DNSFilterOptions::categories_of({category})); }
+        Plan& allow(unsigned int category) { return allow(DNSFilterOptions::categories_of({category})); }
+
+        // arbitrary per-profile edits, e.g. only some profiles or attributes besides the category filters
+        template<typename F>
+        Plan& edit(F change) {
+            for (std::size_t i = 0; i < profiles.size(); ++i) {
+                change(profiles[i]);
+                edited[i] = true;
+            }
+            return *this;
+        }
+
+        // the profiles apply() would PUT, in fetch order
+        [[nodiscard]] std::vector<DNSProfileChange> changes() const {
+            std::vector<DNSProfileChange> result;
+            for (std::size_t i = 0; i < profiles.size(); ++i) {
+                auto body = patch(i);
+                if (body.empty()) continue;
+
+                const auto &before = originals[i].ftgd_dns, &after = profiles[i].ftgd_dns;
+                result.push_back({originals[i].name,
+                                  after.blocked() & ~before.blocked(),
+                                  after.monitored() & ~before.monitored(),
+                                  after.allowed() & ~before.allowed(),
+                                  before.categories() & ~after.categories(),
+                                  std::move(body)});
+            }
+            return result;
+        }
+
+        // human readable dry run, one line per changed profile
+        [[nodiscard]] std::string report() const {
+            auto planned_changes = changes();
+            std::string out;
+            for (const auto& change : planned_changes) {
+                out += change.profile + ":";
+                for (const auto& [label, categories] : {std::pair{"block", &change.blocked},
+                                                        std::pair{"monitor", &change.monitored},
+                                                        std::pair{"allow", &change.allowed},
+                                                        std::pair{"unfiltered", &change.unfiltered}})
+                    if (categories->any()) out += std::format(" {} [{}]", label, list(*categories));
+                for (const auto& [key, value] : change.patch.items())
+                    if (key != DNSProfile::wire_key(&DNSProfile::ftgd_dns)) out += std::format(" {}={}", key, value.dump());
+                out += '\n';
+            }
+            out += std::format("{} of {} profiles change\n", planned_changes.size(), profiles.size());
+            return out;
+        }
+
+        // PUTs the changed profiles; those that succeed become the new baseline, so applying twice sends nothing
+        BulkResult apply(std::size_t concurrency = Bulk::max_concurrency) {
+            auto planned_changes = changes();
+            auto result = Bulk::apply(planned_changes,
+                                      [](const DNSProfileChange& change) { return object_path(change.profile); },
+                                      [](const DNSProfileChange& change) {
+                                          return FortiAPI::put_async(object_path(change.profile),
+                                                                            Wire::Document{change.patch});
+                                      }, concurrency);
+
+            std::unordered_map<std::string, std::size_t> index;
+            for (std::size_t i = 0; i < originals.size(); ++i) index.emplace(object_path(originals[i].name), i);
+            for (const auto& item : result.items) {
+                if (!item.success) continue;
+                auto i = index.at(item.object);
+                originals[i] = profiles[i];
+                edited[i] = false;
+            }
+            return result;
+        }
+    };
+
+    // every profile, fetched with a single GET
+    static Plan plan() { return Plan(get()); }
+
+    // the named profiles; those that cannot be fetched are recorded in `failures` and left out of the plan
+    static Plan plan(const std::vector<std::string>& names, BulkResult& failures,
+                     std::size_t concurrency = Bulk::max_concurrency) {
+        return Plan(Bulk::fetch(names, object_path, [](const std::string& name) { return get_async(name); }, failures,
+                                concurrency));
+    }
+
     static void update(const DNSProfile& profile) {
         if (!contains(profile.name)) throw std::runtime_error("Can't update non-existent DNS Profile");
         FortiAPI::put(std::format("{}/{}", api_endpoint, profile.name), profile);
@@ -27,26 +177,65 @@ public:
     }
 
     static bool contains(const std::string& name) {
-        return FortiAPI::get<DNSProfilesResponse>(std::format("{}/{}", api_endpoint, name)).http_status == 200;
+        return FortiAPI::get<LazyResponse<DNSProfile>>(std::format("{}/{}", api_endpoint, name)).http_status == 200;
+    }
+
+    static std::vector<DNSProfile> get() { return FortiAPI::get<DNSProfilesResponse>(api_endpoint).results; }
+
+    static std::vector<DNSProfile> get(const Query<DNSProfile>& query) {
+        return FortiAPI::get<DNSProfilesResponse>(query.apply(api_endpoint)).results;
     }
 
-    static std::vector<DNSProfile> get() {
-        auto results = FortiAPI::get<DNSProfilesResponse>(api_endpoint).results;
-        for (auto& profile : results) profile.ftgd_dns.sort_filters();
-        return results;
+    // only the listed members are requested and decoded, e.g. get<&DNSProfile::name, &DNSProfile::comment>()
+    template<auto Member, auto... Members>
+    static std::vector<DNSProfile> get(const Query<DNSProfile>& query = {}) {
+        auto path = Projection<DNSProfile, Member, Members...>::apply(query.apply(api_endpoint));
+        return FortiAPI::get<DNSProfilesResponse>(path).results;
+    }
+
+    static Paginated<DNSProfile, DNSProfilesResponse> paged(
+            std::size_t page_size = Paginated<DNSProfile, DNSProfilesResponse>::default_page_size) {
+        return {api_endpoint, page_size};
     }
 
     static DNSProfile get(const std::string& feed) {
-        auto result = FortiAPI::get<DNSProfilesResponse>(std::format("{}/{}", api_endpoint, feed)).results[0];
-        result.ftgd_dns.sort_filters();
-        return result;
+        return FortiAPI::get<DNSProfilesResponse>(std::format("{}/{}", api_endpoint, feed)).results[0];
     }
 
-    static void global_allow_category(unsigned int category) {
-        for (auto& profile : get()) {
-            profile.allow_category(category);
-            update(profile);
-        }
+    // async variants skip the client-side existence checks; FortiOS reports missing objects in the Response
+    static std::future<Response> update_async(const DNSProfile& profile) {
+        return FortiAPI::put_async(std::format("{}/{}", api_endpoint, profile.name), profile);
+    }
+
+    static std::future<Response> add_async(const std::string& name) {
+        return FortiAPI::post_async(api_endpoint, DNSProfile(name));
+    }
+
+    static std::future<Response> del_async(const std::string& name) {
+        return FortiAPI::del_async(std::format("{}/{}", api_endpoint, name));
+    }
+
+    static std::future<bool> contains_async(const std::string& name) {
+        return FortiAPI::get_async<LazyResponse<DNSProfile>>(std::format("{}/{}", api_endpoint, name),
+                [](const LazyResponse<DNSProfile>& response) { return response.http_status == 200; });
+    }
+
+    static std::future<std::vector<DNSProfile>> get_async() {
+        return FortiAPI::get_async<DNSProfilesResponse>(api_endpoint, [](DNSProfilesResponse response) {
+            return std::move(response.results);
+        });
+    }
+
+    static std::future<DNSProfile> get_async(const std::string& feed) {
+        return FortiAPI::get_async<DNSProfilesResponse>(std::format("{}/{}", api_endpoint, feed),
+                [](DNSProfilesResponse response) { return std::move(response.results.at(0)); });
+    }
+
+    static std::string object_path(const std::string& name) { return std::format("{}/{}", api_endpoint, name); }
+
+    // every profile is fetched once; only profiles that filtered the category are PUT (at most `concurrency` at once)
+    static BulkResult global_allow_category(unsigned int category, std::size_t concurrency = Bulk::max_concurrency) {
+        return plan().allow(category).apply(concurrency);
     }
 
     static void block_category_in_profile(const std::string& profile_name, unsigned int category) {
@@ -55,8 +244,11 @@ public:
         update(profile);
     }
 
-    static void block_category_in_profiles(const std::vector<std::string>& profiles, unsigned int category) {
-        for (const auto& name : profiles) block_category_in_profile(name, category);
+    static BulkResult block_category_in_profiles(const std::vector<std::string>& profiles, unsigned int category,
+                                                 std::size_t concurrency = Bulk::max_concurrency) {
+        BulkResult result;
+        result.merge(plan(profiles, result, concurrency).block(category).apply(concurrency));
+        return result;
     }
 };
 
@@ -0,0 +1,138 @@
+#ifndef FORTI_API_FEED_SYNC_HPP
+#define FORTI_API_FEED_SYNC_HPP
+
+#include <cstddef>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+#include "threat_feed.hpp"
+
+
+struct FeedDelta {
+    std::vector<std::string> added, removed;
+    bool snapshot{};
+    unsigned int requests{};
+};
+
+
+/*
+ * Keeps the last state pushed to each push-type threat feed and turns a new full list into FortiOS incremental
+ * `add` / `remove` commands, sent in chunks of at most `max_chunk_bytes`.  A snapshot is only pushed when the feed
+ * state is unknown or the delta would be larger than the full list; large snapshots are sent as one snapshot chunk
+ * followed by `add` chunks.  A failed push forgets the feed so the next sync starts over with a snapshot.  State is
+ * kept per gateway of the calling thread (see FortiClient).
+ */
+class FeedSync {
+    inline static std::mutex mutex;
+    inline static std::unordered_map<std::string, std::unordered_set<std::string>> pushed;  // by key()
+
+    // the same feed name on two FortiGates is two independent feeds
+    static std::string key(const std::string& feed) { return FortiAPI::gateway() + '\0' + feed; }
+
+    // rough JSON size of an entry inside an "entries" array: quotes plus separator
+    static std::size_t wire_size(const std::string& entry) { return entry.size() + 3; }
+
+    static std::size_t wire_size(const std::vector<std::string>& entries) {
+        std::size_t size = 0;
+        for (const auto& entry : entries) size += wire_size(entry);
+        return size;
+    }
+
+    static bool push(const std::string& feed, const std::string& command, const std::vector<std::string>& entries,
+                     FeedDelta& delta) {
+        std::vector<std::string> chunk;
+        std::size_t chunk_bytes = 0;
+        std::string current = command;
+
+        auto flush = [&] {
+            ++delta.requests;
+            auto response = ThreatFeed::update_feed(CommandsRequest(CommandEntry(feed, std::move(chunk), current)));
+            chunk.clear();
+            chunk_bytes = 0;
+            if (current == "snapshot") current = "add";  // the rest of a snapshot is appended to it
+            return response.status == "success";
+        };
+
+        if (entries.empty() && command == "snapshot") return flush();
+        for (const auto& entry : entries) {
+            if (!chunk.empty() && chunk_bytes + wire_size(entry) > max_chunk_bytes && !flush()) return false;
+            chunk_bytes += wire_size(entry);
+            chunk.push_back(entry);
+        }
+        return chunk.empty() || flush();
+    }
+
+public:
+    inline static std::size_t max_chunk_bytes = 256 * 1024;
+
+    // start from what the FortiGate currently serves instead of forcing an initial snapshot
+    static void seed(const std::string& feed) {
+        std::unordered_set<std::string> entries;
+        ThreatFeed::for_each_entry(feed, [&entries](Entry entry) { entries.insert(std::move(entry.entry)); });
+
+        std::lock_guard lock(mutex);
+        pushed[key(feed)] = std::move(entries);
+    }
+
+    // start from a list already known to be on the FortiGate (e.g. kept from a previous run)
+    static void seed(const std::string& feed, const std::vector<std::string>& entries) {
+        std::lock_guard lock(mutex);
+        pushed[key(feed)] = std::unordered_set<std::string>(entries.begin(), entries.end());
+    }
+
+    static void forget(const std::string& feed) {
+        std::lock_guard lock(mutex);
+        pushed.erase(key(feed));
+    }
+
+    // what sync() would send, without sending it
+    static FeedDelta plan(const std::string& feed, const std::vector<std::string>& entries) {
+        FeedDelta delta;
+        std::lock_guard lock(mutex);
+
+        auto known = pushed.find(key(feed));
+        if (known == pushed.end()) {
+            delta.snapshot = true;
+            delta.added = entries;
+            return delta;
+        }
+
+        std::unordered_set<std::string> next(entries.begin(), entries.end());
+        for (const auto& entry : next) if (!known->second.contains(entry)) delta.added.push_back(entry);
+        for (const auto& entry : known->second) if (!next.contains(entry)) delta.removed.push_back(entry);
+
+        if (wire_size(delta.added) + wire_size(delta.removed) > wire_size(entries)) {
+            delta.snapshot = true;
+            delta.added = entries;
+            delta.removed.clear();
+        }
+        return delta;
+    }
+
+    static FeedDelta sync(const std::string& feed, const std::vector<std::string>& entries) {
+        auto delta = plan(feed, entries);
+
+        bool ok = false;
+        try {
+            ok = delta.snapshot ? push(feed, "snapshot", delta.added, delta)
+                                : push(feed, "remove", delta.removed, delta) && push(feed, "add", delta.added, delta);
+        } catch (...) {
+            // chunks sent before the failure are already applied, so the pushed state no longer matches
+            forget(feed);
+            throw;
+        }
+        if (!ok) {
+            forget(feed);
+            throw std::runtime_error("Threat feed push failed, next sync will resend a snapshot: " + feed);
+        }
+
+        std::lock_guard lock(mutex);
+        pushed[key(feed)] = std::unordered_set<std::string>(entries.begin(), entries.end());
+        return delta;
+    }
+};
+
+#endif //FORTI_API_FEED_SYNC_HPP
@@ -5,9 +5,12 @@
 #ifndef FORTI_API_FIREWALL_HPP
 #define FORTI_API_FIREWALL_HPP
 
+#include <future>
 #include <utility>
 
 #include "api.hpp"
+#include "paginated.hpp"
+#include "query.hpp"
 #include "types/firewall/policies.h"
 #include "types/firewall/services.h"
 #include "types/firewall/schedules.h"
@@ -21,15 +24,74 @@ namespace FortiGate {
     public:
         static std::vector<FirewallPolicy> get() { return FortiAPI::get<FirewallPoliciesResponse>(endpoint).results; }
 
+        static std::vector<FirewallPolicy> get(const Query<FirewallPolicy>& query) {
+            return FortiAPI::get<FirewallPoliciesResponse>(query.apply(endpoint)).results;
+        }
+
+        // only the listed members are requested and decoded, e.g. get<&FirewallPolicy::policyid, &FirewallPolicy::status>()
+        template<auto Member, auto... Members>
+        static std::vector<FirewallPolicy> get(const Query<FirewallPolicy>& query = {}) {
+            auto path = Projection<FirewallPolicy, Member, Members...>::apply(query.apply(endpoint));
+            return FortiAPI::get<FirewallPoliciesResponse>(path).results;
+        }
+
         static FirewallPolicy get(const std::string& name) {
-            auto policies = get();
-            for (const auto& policy : policies) if (policy.name == name) return policy;
-            throw std::runtime_error("Unable to locate firewall policy: " + name);
+            auto policies = get(Query<FirewallPolicy>().eq(&FirewallPolicy::name, name));
+            if (policies.empty()) throw std::runtime_error("Unable to locate firewall policy: " + name);
+            return policies[0];
         }
 
         static void update(const FirewallPolicy& policy) {
             FortiAPI::put(std::format("{}/{}", endpoint, policy.policyid), policy);
         }
+
+        // partial PUT carrying only the attributes `updated` changed relative to `original` (no request if none)
+        static void update(const FirewallPolicy& updated, const FirewallPolicy& original) {
+            auto patch = Wire::diff(original, updated);
+            if (!patch.empty()) FortiAPI::put(std::format("{}/{}", endpoint, original.policyid), Wire::Document{patch});
+        }
+
+        static Paginated<FirewallPolicy, FirewallPoliciesResponse> paged(
+                std::size_t page_size = Paginated<FirewallPolicy, FirewallPoliciesResponse>::default_page_size) {
+            return {endpoint, page_size};
+        }
+
+        // streams the policy table; `fn` receives each FirewallPolicy as soon as it has been downloaded
+        template<typename F>
+        static Response for_each(F fn) { return FortiAPI::stream<FirewallPolicy>(endpoint, {"results"}, std::move(fn)); }
+
+        static std::future<std::vector<FirewallPolicy>> get_async() {
+            return FortiAPI::get_async<FirewallPoliciesResponse>(endpoint, [](FirewallPoliciesResponse response) {
+                return std::move(response.results);
+            });
+        }
+
+        static std::future<FirewallPolicy> get_async(const std::string& name) {
+            auto query = Query<FirewallPolicy>().eq(&FirewallPolicy::name, name);
+            return FortiAPI::get_async<FirewallPoliciesResponse>(query.apply(endpoint), [name](FirewallPoliciesResponse response) {
+                if (response.results.empty()) throw std::runtime_error("Unable to locate firewall policy: " + name);
+                return std::move(response.results[0]);
+            });
+        }
+
+        static std::future<Response> update_async(const FirewallPolicy& policy) {
+            return FortiAPI::put_async(std::format("{}/{}", endpoint, policy.policyid), policy);
+        }
+
+        static std::future<Response> update_async(const FirewallPolicy& updated, const FirewallPolicy& original) {
+            auto patch = Wire::diff(original, updated);
+            if (patch.empty()) {  // nothing to send, but still a success for Bulk::apply and other status checks
+                Response response;
+                response.http_method = "PUT";
+                response.status = "success";
+                response.http_status = 200;
+                std::promise<Response> unchanged;
+                unchanged.set_value(std::move(response));
+                return unchanged.get_future();
+            }
+            return FortiAPI::put_async(std::format("{}/{}", endpoint, original.policyid),
+                                       Wire::Document{std::move(patch)});
+        }
     };
 
 
@@ -39,6 +101,11 @@ namespace FortiGate {
             return FortiAPI::get<FirewallServicesResponse>(FirewallService::endpoint).results;
         }
 
+        static std::vector<FirewallService> get(const Query<FirewallService>& query, const std::string& vdom="root") {
+            auto endpoint = std::format("{}?vdom={}", FirewallService::endpoint, vdom);
+            return FortiAPI::get<FirewallServicesResponse>(query.apply(endpoint)).results;
+        }
+
         static FirewallService get(const std::string& name, const std::string& vdom="root") {
             auto results = FortiAPI::get<FirewallServicesResponse>(std::format("{}/{}?vdom={}", FirewallService::endpoint, name, vdom)).results;
             if (results.empty()) throw std::runtime_error("Unable to locate firewall service: " + name);
@@ -54,10 +121,53 @@ namespace FortiGate {
             FortiAPI::post(std::format("{}?vdom={}", FirewallService::endpoint, vdom), service);
         }
 
+        static Paginated<FirewallService, FirewallServicesResponse> paged(const std::string& vdom="root",
+                std::size_t page_size = Paginated<FirewallService, FirewallServicesResponse>::default_page_size) {
+            return {std::format("{}?vdom={}", FirewallService::endpoint, vdom), page_size};
+        }
+
+        template<typename F>
+        static Response for_each(F fn, const std::string& vdom="root") {
+            return FortiAPI::stream<FirewallService>(std::format("{}?vdom={}", FirewallService::endpoint, vdom),
+                                                     {"results"}, std::move(fn));
+        }
+
+        static std::future<std::vector<FirewallService>> get_async() {
+            return FortiAPI::get_async<FirewallServicesResponse>(FirewallService::endpoint,
+                    [](FirewallServicesResponse response) { return std::move(response.results); });
+        }
+
+        static std::future<FirewallService> get_async(const std::string& name, const std::string& vdom="root") {
+            auto endpoint = std::format("{}/{}?vdom={}", FirewallService::endpoint, name, vdom);
+            return FortiAPI::get_async<FirewallServicesResponse>(endpoint, [name](FirewallServicesResponse response) {
+                auto& results = response.results;
+                if (results.empty()) throw std::runtime_error("Unable to locate firewall service: " + name);
+                else if (results.size() > 1) throw std::runtime_error("Get of firewall service " + name + " returned multiple results");
+                return std::move(results[0]);
+            });
+        }
+
+        static std::future<Response> update_async(const FirewallService& service, const std::string& vdom="root") {
+            return FortiAPI::put_async(std::format("{}/{}?vdom={}", FirewallService::endpoint, service.name, vdom), service);
+        }
+
+        static std::future<Response> add_async(const FirewallService& service, const std::string& vdom="root") {
+            return FortiAPI::post_async(std::format("{}?vdom={}", FirewallService::endpoint, vdom), service);
+        }
+
+        static std::future<std::vector<ServiceCategory>> get_categories_async() {
+            return FortiAPI::get_async<ServiceCategoriesResponse>(ServiceCategory::endpoint,
+                    [](ServiceCategoriesResponse response) { return std::move(response.results); });
+        }
+
         static std::vector<ServiceCategory> get_categories() {
             return FortiAPI::get<ServiceCategoriesResponse>(ServiceCategory::endpoint).results;
         }
 
+        static std::vector<ServiceCategory> get_categories(const Query<ServiceCategory>& query) {
+            return FortiAPI::get<ServiceCategoriesResponse>(query.apply(ServiceCategory::endpoint)).results;
+        }
+
         static void add_category(ServiceCategory category) { category.add(); }
 
         static void add_category(const std::string& name, const std::string& comment="") {
@@ -67,11 +177,9 @@ namespace FortiGate {
         static void delete_category(ServiceCategory category) { category.del(); }
 
         static void delete_category(const std::string& name) {
-            for (auto category : get_categories()) {
-                if (category.name == name) category.del();
-                return;
-            }
-            throw std::runtime_error("Unable to locate category for deletion: " + name);
+            auto categories = get_categories(Query<ServiceCategory>().eq(&ServiceCategory::name, name));
+            if (categories.empty()) throw std::runtime_error("Unable to locate category for deletion: " + name);
+            categories[0].del();
         }
     };
 
@@ -89,6 +197,21 @@ namespace FortiGate {
             return results[0];
         }
 
+        static std::future<std::vector<FirewallSchedule>> get_async(const std::string& vdom="root") {
+            return FortiAPI::get_async<FirewallSchedulesResponse>(std::format("{}?vdom={}", FirewallSchedule::endpoint, vdom),
+                    [](FirewallSchedulesResponse response) { return std::move(response.results); });
+        }
+
+        static std::future<FirewallSchedule> get_async(const std::string& name, const std::string& vdom="root") {
+            auto endpoint = std::format("{}/{}?vdom={}", FirewallSchedule::endpoint, name, vdom);
+            return FortiAPI::get_async<FirewallSchedulesResponse>(endpoint, [name](FirewallSchedulesResponse response) {
+                auto& results = response.results;
+                if (results.empty()) throw std::runtime_error("Unable to locate firewall schedule: " + name);
+                else if (results.size() > 1) throw std::runtime_error("Get of firewall schedule " + name + " returned multiple results");
+                return std::move(results[0]);
+            });
+        }
+
         static FirewallSchedule new_schedule(const std::string& name, const std::string& vdom="root") {
             return FirewallSchedule(name, vdom);
         }
@@ -0,0 +1,201 @@
+#ifndef FORTI_API_INTERFACE_CACHE_HPP
+#define FORTI_API_INTERFACE_CACHE_HPP
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <shared_mutex>
+#include <stop_token>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include "api.hpp"
+#include "types/system/interface.h"
+
+
+/*
+ * View of /monitor/system/available-interfaces per gateway, indexed by (name, vdom) and by type.
+ *
+ * Readers load an immutable Snapshot through an atomic shared_ptr and never take a lock.  A snapshot older than
+ * `ttl` is refetched on the next lookup (one thread fetches, concurrent callers wait for its result).  With
+ * start_refresher() a background thread republishes the snapshot every interval instead, so lookups don't wait on
+ * the network; should its refreshes keep failing until the snapshot is older than twice max(ttl, interval), lookups
+ * go back to refetching synchronously (and throw when that fails too).  Call stop_refresher() before shutting the
+ * process down.  Every static below acts on the gateway of the calling thread (see FortiClient).
+ */
+class InterfaceCache {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    struct Snapshot {
+        std::vector<SystemInterface> interfaces;
+        std::unordered_map<std::string, std::size_t> by_name;  // name + '\0' + vdom
+        std::unordered_map<std::string, std::vector<std::size_t>> by_type;
+        Clock::time_point fetched;
+
+        explicit Snapshot(std::vector<SystemInterface> list) : interfaces(std::move(list)), fetched(now()) {
+            by_name.reserve(interfaces.size());
+            for (std::size_t i = 0; i < interfaces.size(); ++i) {
+                by_name.emplace(key(interfaces[i].name, interfaces[i].vdom), i);
+                by_type[interfaces[i].type].push_back(i);
+            }
+        }
+
+        [[nodiscard]] const SystemInterface* find(std::string_view name, std::string_view vdom = "root") const {
+            auto it = by_name.find(key(name, vdom));
+            return it == by_name.end() ? nullptr : &interfaces[it->second];
+        }
+
+        [[nodiscard]] std::vector<SystemInterface> of_type(const std::string& type) const {
+            std::vector<SystemInterface> matches;
+            if (auto it = by_type.find(type); it != by_type.end()) {
+                matches.reserve(it->second.size());
+                for (auto index : it->second) matches.push_back(interfaces[index]);
+            }
+            return matches;
+        }
+
+    private:
+        static std::string key(std::string_view name, std::string_view vdom) {
+            std::string joined;
+            joined.reserve(name.size() + vdom.size() + 1);
+            joined.append(name).push_back('\0');
+            joined.append(vdom);
+            return joined;
+        }
+    };
+
+private:
+    struct Slot {
+        std::atomic<std::shared_ptr<const Snapshot>> current;
+        std::mutex refresh_mutex;
+        std::mutex refresher_mutex;  // the refresher's sleep between refreshes
+        std::mutex control_mutex;    // start_refresher() / stop_refresher()
+        std::condition_variable_any refresher_wake;
+        std::jthread refresher;
+        std::atomic<bool> refreshing{false};
+        std::atomic<Clock::rep> interval_ticks{0};
+    };
+
+    inline static std::string endpoint = "/monitor/system/available-interfaces";
+    inline static std::atomic<Clock::rep> ttl_ticks{std::chrono::duration_cast<Clock::duration>(std::chrono::seconds(60)).count()};
+    inline static std::atomic<Clock::time_point (*)()> clock{&Clock::now};
+    inline static std::shared_mutex slots_mutex;
+    inline static std::map<std::string, std::unique_ptr<Slot>, std::less<>> slots;  // per gateway, never freed
+
+    static Slot& slot() {
+        auto gateway = FortiAPI::gateway();
+        {
+            std::shared_lock lock(slots_mutex);
+            if (auto it = slots.find(gateway); it != slots.end()) return *it->second;
+        }
+        std::unique_lock lock(slots_mutex);
+        auto& entry = slots[gateway];
+        if (!entry) entry = std::make_unique<Slot>();
+        return *entry;
+    }
+
+    static Clock::time_point now() { return clock.load(std::memory_order_relaxed)(); }
+
+    static std::shared_ptr<const Snapshot> refresh(Slot& target) {
+        auto snapshot = std::make_shared<const Snapshot>(FortiAPI::get<SystemInterfacesResponse>(endpoint).results);
+        target.current.store(snapshot);
+        return snapshot;
+    }
+
+    static bool stale(const std::shared_ptr<const Snapshot>& snapshot) {
+        return !snapshot || now() - snapshot->fetched > Clock::duration(ttl_ticks.load(std::memory_order_relaxed));
+    }
+
+    // a stale snapshot the background refresher is expected to replace shortly; past twice its period it evidently won't
+    static bool awaiting_refresher(const Slot& target, const std::shared_ptr<const Snapshot>& snapshot) {
+        if (!snapshot || !target.refreshing.load(std::memory_order_relaxed)) return false;
+        auto period = std::max(ttl_ticks.load(std::memory_order_relaxed),
+                               target.interval_ticks.load(std::memory_order_relaxed));
+        return now() - snapshot->fetched <= 2 * Clock::duration(period);
+    }
+
+    // callers hold target.control_mutex
+    static void stop(Slot& target) {
+        if (target.refresher.joinable()) {
+            target.refresher.request_stop();
+            target.refresher.join();
+        }
+        target.refreshing = false;
+    }
+
+public:
+    static void set_ttl(Clock::duration ttl) { ttl_ticks = ttl.count(); }
+
+    [[nodiscard]] static Clock::duration ttl() { return Clock::duration(ttl_ticks.load()); }
+
+    // time source for snapshot ages (Clock::now by default); lets the staleness rules be driven deterministically
+    static void set_clock(Clock::time_point (*source)()) { clock = source ? source : &Clock::now; }
+
+    static std::shared_ptr<const Snapshot> publish(std::vector<SystemInterface> interfaces) {
+        auto snapshot = std::make_shared<const Snapshot>(std::move(interfaces));
+        slot().current.store(snapshot);
+        return snapshot;
+    }
+
+    // fetches and publishes a new snapshot unconditionally
+    static std::shared_ptr<const Snapshot> refresh() { return refresh(slot()); }
+
+    // the current snapshot; refetched first when missing, or when stale and the background refresher isn't keeping up
+    static std::shared_ptr<const Snapshot> snapshot() {
+        auto& target = slot();
+        auto snapshot = target.current.load();
+        if (!stale(snapshot) || awaiting_refresher(target, snapshot)) return snapshot;
+
+        std::lock_guard lock(target.refresh_mutex);
+        snapshot = target.current.load();  // another caller may have refreshed while we waited
+        return stale(snapshot) && !awaiting_refresher(target, snapshot) ? refresh() : snapshot;
+    }
+
+    static void invalidate() { slot().current.store(nullptr); }
+
+    static void start_refresher(Clock::duration interval) {
+        auto& target = slot();
+        std::lock_guard control(target.control_mutex);
+        stop(target);
+        std::optional<FortiClient> client;
+        if (auto active = FortiClient::current()) client = *active;
+
+        target.interval_ticks = interval.count();
+        target.refreshing = true;
+        auto gateway = FortiAPI::gateway();
+        target.refresher = std::jthread([&target, client, interval, gateway](std::stop_token stop) {
+            // only ever refreshes the slot it was started for: once a reload points the client (or FortiAuth) at
+            // another gateway, ticks are skipped and lookups fall back to refetching once the snapshot goes stale
+            auto tick = [&target, &gateway] { if (FortiAPI::gateway() == gateway) refresh(target); };
+            while (!stop.stop_requested()) {
+                try {
+                    if (client) client->run(tick);
+                    else tick();
+                } catch (const std::exception& e) {
+                    std::cerr << "[WARNING] Interface refresh failed, keeping the previous snapshot: " << e.what() << "\n";
+                }
+                std::unique_lock lock(target.refresher_mutex);
+                target.refresher_wake.wait_for(lock, stop, interval, [] { return false; });
+            }
+        });
+    }
+
+    static void stop_refresher() {
+        auto& target = slot();
+        std::lock_guard control(target.control_mutex);
+        stop(target);
+    }
+};
+
+#endif //FORTI_API_INTERFACE_CACHE_HPP
@@ -0,0 +1,260 @@
+#ifndef FORTI_API_METRICS_HPP
+#define FORTI_API_METRICS_HPP
+
+#include <curl/curl.h>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <format>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <nlohmann/json.hpp>
+
+
+/*
+ * Per endpoint + method request metrics, recorded from curl's own timers after every transfer.
+ *
+ * Paths are normalised so the number of series stays bounded: the query string is dropped and object keys are
+ * collapsed ("/cmdb/firewall/policy/12?vdom=root" -> "/cmdb/firewall/policy/{mkey}", and past the action of a monitor
+ * call: "/monitor/system/external-resource/dynamic/feed" -> "/monitor/system/external-resource/dynamic/{mkey}").
+ * Recording is a shared-lock lookup plus a handful of relaxed atomic increments; the exporters take a
+ * consistent-enough snapshot on demand.
+ *
+ * Phases are derived from CURLINFO_*_TIME_T: dns, connect and tls are only observed when the transfer opened a new
+ * connection, ttfb is the server's think time (request sent -> first response byte), total is the whole transfer
+ * and decode is the JSON -> T conversion after it.
+ */
+class Metrics {
+public:
+    enum Phase : std::size_t { Dns, Connect, Tls, Ttfb, Total, Decode, PhaseCount };
+
+    // upper bounds in seconds; the last bucket is +Inf
+    static constexpr std::array<double, 14> bounds = {0.0005, 0.001, 0.0025, 0.005, 0.01, 0.025, 0.05, 0.1, 0.25, 0.5,
+                                                      1, 2.5, 5, 10};
+
+    struct Histogram {
+        std::array<std::atomic<unsigned long long>, bounds.size() + 1> buckets{};
+        std::atomic<unsigned long long> count{0}, sum_us{0};
+
+        void observe(long long microseconds) {
+            if (microseconds < 0) return;
+            double seconds = static_cast<double>(microseconds) / 1e6;
+            std::size_t bucket = 0;
+            while (bucket < bounds.size() && seconds > bounds[bucket]) ++bucket;
+            buckets[bucket].fetch_add(1, std::memory_order_relaxed);
+            count.fetch_add(1, std::memory_order_relaxed);
+            sum_us.fetch_add(static_cast<unsigned long long>(microseconds), std::memory_order_relaxed);
+        }
+
+        // upper bound of the bucket holding the q-quantile (0 when empty)
+        [[nodiscard]] double quantile(double q) const {
+            auto total = count.load(std::memory_order_relaxed);
+            if (total == 0) return 0;
+            auto rank = static_cast<unsigned long long>(q * static_cast<double>(total));
+            unsigned long long seen = 0;
+            for (std::size_t i = 0; i < buckets.size(); ++i) {
+                seen += buckets[i].load(std::memory_order_relaxed);
+                if (seen > rank) return i < bounds.size() ? bounds[i] : bounds.back();
+            }
+            return bounds.back();
+        }
+    };
+
+    struct Series {
+        std::atomic<unsigned long long> requests{0}, errors{0}, bytes_in{0}, bytes_out{0}, new_connections{0},
+                reused_connections{0};
+        std::array<Histogram, PhaseCount> phases{};
+    };
+
+private:
+    inline static std::shared_mutex mutex;
+    inline static std::map<std::pair<std::string, std::string>, std::unique_ptr<Series>, std::less<>> series;
+    inline static std::atomic<bool> active{true};
+
+    static constexpr std::array<std::string_view, PhaseCount> phase_names = {"dns", "connect", "tls", "ttfb", "total",
+                                                                              "decode"};
+
+    static Series& lookup(std::string_view method, std::string_view path) {
+        auto key = std::make_pair(std::string(method), normalize(path));
+        {
+            std::shared_lock lock(mutex);
+            if (auto it = series.find(key); it != series.end()) return *it->second;
+        }
+        std::unique_lock lock(mutex);
+        auto& entry = series[std::move(key)];
+        if (!entry) entry = std::make_unique<Series>();
+        return *entry;
+    }
+
+    static std::string escape(std::string_view label) {
+        std::string out;
+        for (char c : label) {
+            if (c == '"' || c == '\\') out.push_back('\\');
+            out.push_back(c);
+        }
+        return out;
+    }
+
+public:
+    static void enable(bool on = true) { active = on; }
+
+    [[nodiscard]] static bool enabled() { return active.load(std::memory_order_relaxed); }
+
+    static std::string normalize(std::string_view path) {
+        path = path.substr(0, path.find('?'));
+        // /cmdb/{path}/{name} tables and /monitor/{path}/{name}/{action} calls: whatever follows is an object
+        int depth = path.starts_with("/cmdb/") ? 3 : path.starts_with("/monitor/") ? 4 : 0;
+        if (depth == 0) return std::string(path);
+
+        std::size_t end = 0;
+        for (int segments = 0; segments < depth && end != std::string_view::npos; ++segments)
+            end = path.find('/', end + 1);
+        if (end == std::string_view::npos || end + 1 >= path.size()) return std::string(path.substr(0, end));
+        return std::string(path.substr(0, end)) + "/{mkey}";
+    }
+
+    // the series of one endpoint + method, for callers that record the same endpoint over and over without a lookup
+    static Series& series_for(std::string_view method, std::string_view path) { return lookup(method, path); }
+
+    // after a transfer finished (successfully or not); returns the series so the decode time can be added to it
+    static Series* record(CURL* handle, std::string_view method, std::string_view path, CURLcode result) {
+        if (!enabled()) return nullptr;
+        return record(lookup(method, path), handle, result);
+    }
+
+    static Series* record(Series& entry, CURL* handle, CURLcode result) {
+        if (!enabled()) return nullptr;
+
+        long status = 0, connects = 0;
+        curl_off_t name_lookup = 0, connect = 0, app_connect = 0, pre_transfer = 0, start_transfer = 0, total = 0,
+                downloaded = 0, uploaded = 0;
+        curl_easy_getinfo(handle, CURLINFO_RESPONSE_CODE, &status);
+        curl_easy_getinfo(handle, CURLINFO_NUM_CONNECTS, &connects);
+        curl_easy_getinfo(handle, CURLINFO_NAMELOOKUP_TIME_T, &name_lookup);
+        curl_easy_getinfo(handle, CURLINFO_CONNECT_TIME_T, &connect);
+        curl_easy_getinfo(handle, CURLINFO_APPCONNECT_TIME_T, &app_connect);
+        curl_easy_getinfo(handle, CURLINFO_PRETRANSFER_TIME_T, &pre_transfer);
+        curl_easy_getinfo(handle, CURLINFO_STARTTRANSFER_TIME_T, &start_transfer);
+        curl_easy_getinfo(handle, CURLINFO_TOTAL_TIME_T, &total);
+        curl_easy_getinfo(handle, CURLINFO_SIZE_DOWNLOAD_T, &downloaded);
+        curl_easy_getinfo(handle, CURLINFO_SIZE_UPLOAD_T, &uploaded);
+
+        entry.requests.fetch_add(1, std::memory_order_relaxed);
+        if (result != CURLE_OK || status >= 400) entry.errors.fetch_add(1, std::memory_order_relaxed);
+        entry.bytes_in.fetch_add(static_cast<unsigned long long>(downloaded), std::memory_order_relaxed);
+        entry.bytes_out.fetch_add(static_cast<unsigned long long>(uploaded), std::memory_order_relaxed);
+
+        if (connects > 0) {
+            entry.new_connections.fetch_add(1, std::memory_order_relaxed);
+            entry.phases[Dns].observe(name_lookup);
+            entry.phases[Connect].observe(connect - name_lookup);
+            if (app_connect > 0) entry.phases[Tls].observe(app_connect - connect);
+        } else entry.reused_connections.fetch_add(1, std::memory_order_relaxed);
+
+        if (start_transfer > 0) entry.phases[Ttfb].observe(start_transfer - pre_transfer);
+        entry.phases[Total].observe(total);
+        return &entry;
+    }
+
+    static void record_decode(Series* entry, std::chrono::steady_clock::duration elapsed) {
+        if (entry)
+            entry->phases[Decode].observe(std::chrono::duration_cast<std::chrono::microseconds>(elapsed).count());
+    }
+
+    // zeroes every series in place; series are never freed so pointers handed out by record() stay valid
+    static void reset() {
+        std::unique_lock lock(mutex);
+        for (auto& [key, entry] : series) {
+            for (auto* counter : {&entry->requests, &entry->errors, &entry->bytes_in, &entry->bytes_out,
+                                  &entry->new_connections, &entry->reused_connections}) counter->store(0);
+            for (auto& histogram : entry->phases) {
+                for (auto& bucket : histogram.buckets) bucket.store(0);
+                histogram.count.store(0);
+                histogram.sum_us.store(0);
+            }
+        }
+    }
+
+    // Prometheus text exposition format (version 0.0.4)
+    static std::string prometheus() {
+        std::shared_lock lock(mutex);
+        std::string out;
+
+        auto counter = [&](std::string_view name, std::string_view help, auto member) {
+            out += std::format("# HELP forti_api_{} {}\n# TYPE forti_api_{} counter\n", name, help, name);
+            for (const auto& [key, entry] : series)
+                out += std::format("forti_api_{}{{endpoint=\"{}\",method=\"{}\"}} {}\n", name, escape(key.second),
+                                   key.first, (entry.get()->*member).load(std::memory_order_relaxed));
+        };
+
+        counter("requests_total", "Completed transfers.", &Series::requests);
+        counter("errors_total", "Transfers that failed or returned HTTP >= 400.", &Series::errors);
+        counter("received_bytes_total", "Response body bytes.", &Series::bytes_in);
+        counter("sent_bytes_total", "Request body bytes.", &Series::bytes_out);
+        counter("new_connections_total", "Transfers that opened a new connection.", &Series::new_connections);
+        counter("reused_connections_total", "Transfers on a kept-alive connection.", &Series::reused_connections);
+
+        out += "# HELP forti_api_phase_seconds Time spent per request phase.\n"
+               "# TYPE forti_api_phase_seconds histogram\n";
+        for (const auto& [key, entry] : series) {
+            for (std::size_t phase = 0; phase < PhaseCount; ++phase) {
+                const auto& histogram = entry->phases[phase];
+                auto labels = std::format("endpoint=\"{}\",method=\"{}\",phase=\"{}\"", escape(key.second), key.first,
+                                          phase_names[phase]);
+                unsigned long long cumulative = 0;
+                for (std::size_t i = 0; i < histogram.buckets.size(); ++i) {
+                    cumulative += histogram.buckets[i].load(std::memory_order_relaxed);
+                    auto le = i < bounds.size() ? std::format("{}", bounds[i]) : std::string("+Inf");
+                    out += std::format("forti_api_phase_seconds_bucket{{{},le=\"{}\"}} {}\n", labels, le, cumulative);
+                }
+                out += std::format("forti_api_phase_seconds_sum{{{}}} {}\n", labels,
+                                   static_cast<double>(histogram.sum_us.load(std::memory_order_relaxed)) / 1e6);
+                out += std::format("forti_api_phase_seconds_count{{{}}} {}\n", labels,
+                                   histogram.count.load(std::memory_order_relaxed));
+            }
+        }
+        return out;
+    }
+
+    static nlohmann::json json() {
+        std::shared_lock lock(mutex);
+        nlohmann::json out = nlohmann::json::array();
+
+        for (const auto& [key, entry] : series) {
+            nlohmann::json phases = nlohmann::json::object();
+            for (std::size_t phase = 0; phase < PhaseCount; ++phase) {
+                const auto& histogram = entry->phases[phase];
+                auto count = histogram.count.load(std::memory_order_relaxed);
+                nlohmann::json buckets = nlohmann::json::array();
+                for (const auto& bucket : histogram.buckets) buckets.push_back(bucket.load(std::memory_order_relaxed));
+
+                phases[phase_names[phase]] = {
+                        {"count", count},
+                        {"mean_seconds", count == 0 ? 0.0
+                                : static_cast<double>(histogram.sum_us.load()) / 1e6 / static_cast<double>(count)},
+                        {"p50_seconds", histogram.quantile(0.50)},
+                        {"p99_seconds", histogram.quantile(0.99)},
+                        {"buckets", std::move(buckets)}};
+            }
+
+            out.push_back({{"endpoint", key.second},
+                           {"method", key.first},
+                           {"requests", entry->requests.load()},
+                           {"errors", entry->errors.load()},
+                           {"bytes_in", entry->bytes_in.load()},
+                           {"bytes_out", entry->bytes_out.load()},
+                           {"new_connections", entry->new_connections.load()},
+                           {"reused_connections", entry->reused_connections.load()},
+                           {"phases", std::move(phases)}});
+        }
+        return out;
+    }
+};
+
+#endif //FORTI_API_METRICS_HPP
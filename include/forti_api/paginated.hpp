@@ -0,0 +1,127 @@
+#ifndef FORTI_API_PAGINATED_HPP
+#define FORTI_API_PAGINATED_HPP
+
+#include <algorithm>
+#include <cstddef>
+#include <functional>
+#include <future>
+#include <iterator>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+#include "api.hpp"
+
+
+/*
+ * Lazy range over a CMDB table, fetched `page_size` objects at a time with FortiOS start/count.  While the caller
+ * works through one page the next one is already in flight on the AsyncEngine, at most one page ahead.  Breaking out
+ * of the loop stops further fetches; only the single prefetched page is ever wasted.
+ *
+ *     for (const auto& policy : Policies::paged()) if (policy.name == "wan-in") break;
+ */
+template<typename T, typename ResponseT>
+class Paginated {
+    struct Page {
+        Response envelope;  // start/count bookkeeping reported by FortiOS for this page
+        std::vector<T> results;
+    };
+
+    struct State {
+        std::string path;
+        std::size_t page_size{}, start{}, index{};
+        std::function<void(T&)> prepare;
+        std::vector<T> page;
+        Response envelope;
+        std::future<Page> next;
+        bool last = false;
+
+        std::future<Page> fetch(std::size_t offset) const {
+            auto endpoint = FortiAPI::append_query(path, std::format("start={}&count={}", offset, page_size));
+            return FortiAPI::get_async<ResponseT>(endpoint, [prepare = prepare](ResponseT response) {
+                if (prepare) for (auto& item : response.results) prepare(item);
+                return Page{.envelope = response, .results = std::move(response.results)};
+            });
+        }
+
+        // swap in the prefetched page and immediately request the one after it
+        void advance_page() {
+            auto fetched = next.get();
+            page = std::move(fetched.results);
+            envelope = std::move(fetched.envelope);
+            index = 0;
+
+            // FortiOS reports the index of the last returned row and the size of the (filtered) table; a filtered or
+            // vdom-scoped table may return short pages before its end, so only fall back to the short-page rule
+            // when a reply leaves those fields out
+            if (page.empty()) last = true;
+            else if (envelope.matched_count > 0) {
+                std::size_t after = envelope.next_idx + 1;
+                start = after > start ? after : start + page.size();
+                last = start >= envelope.matched_count;
+            } else {
+                start += page.size();
+                last = page.size() < page_size;
+            }
+            if (!last) next = fetch(start);
+        }
+    };
+
+    std::string path;
+    std::size_t page_size;
+    std::function<void(T&)> prepare;
+
+public:
+    inline static std::size_t default_page_size = 500;
+
+    class iterator {
+        std::shared_ptr<State> state;
+
+        void skip_exhausted_pages() {
+            while (state && state->index >= state->page.size()) {
+                if (state->last) state.reset();
+                else state->advance_page();
+            }
+        }
+
+    public:
+        using iterator_category = std::input_iterator_tag;
+        using value_type = T;
+        using difference_type = std::ptrdiff_t;
+        using pointer = T*;
+        using reference = T&;
+
+        iterator() = default;
+        explicit iterator(std::shared_ptr<State> state) : state(std::move(state)) { skip_exhausted_pages(); }
+
+        reference operator*() const { return state->page[state->index]; }
+        pointer operator->() const { return &state->page[state->index]; }
+
+        iterator& operator++() {
+            ++state->index;
+            skip_exhausted_pages();
+            return *this;
+        }
+
+        void operator++(int) { ++*this; }
+
+        friend bool operator==(const iterator& it, std::default_sentinel_t) { return !it.state; }
+    };
+
+    Paginated(std::string path, std::size_t page_size = default_page_size, std::function<void(T&)> prepare = {}) :
+            path(std::move(path)), page_size(std::max<std::size_t>(page_size, 1)), prepare(std::move(prepare)) {}
+
+    // every call to begin() starts a fresh walk of the table
+    iterator begin() const {
+        auto state = std::make_shared<State>();
+        state->path = path;
+        state->page_size = page_size;
+        state->prepare = prepare;
+        state->next = state->fetch(0);
+        return iterator(std::move(state));
+    }
+
+    [[nodiscard]] std::default_sentinel_t end() const { return {}; }
+};
+
+#endif //FORTI_API_PAGINATED_HPP
@@ -0,0 +1,115 @@
+#ifndef FORTI_API_PREPARED_REQUEST_HPP
+#define FORTI_API_PREPARED_REQUEST_HPP
+
+#include <cstddef>
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <curl/curl.h>
+#include "api.hpp"
+#include "client.hpp"
+#include "metrics.hpp"
+#include "throttle.hpp"
+
+
+/*
+ * One method + path, set up once and sent over and over with a new body: for loops that push the same feed every few
+ * seconds or poll the same monitor endpoint.
+ *
+ * The URL, header list, curl options, metrics series and a pooled handle are built on construction and kept, and the
+ * response lands in a buffer reserved up front.  send() only points curl at the new body and performs, so once the
+ * buffer is large enough a call allocates nothing in the client; execute() additionally decodes the answer.  A config
+ * reload is picked up by the next call, which rebuilds the transfer once.
+ *
+ * Bound to the FortiClient active on the constructing thread (else FortiAuth).  Not thread-safe: one PreparedRequest
+ * serves one caller at a time, and a body passed to send() only has to live until it returns.
+ *
+ *     PreparedRequest push("POST", "/monitor/system/external-resource/dynamic");
+ *     while (running) push.execute(nlohmann::json(CommandsRequest(...)).dump());
+ */
+class PreparedRequest {
+    std::optional<FortiClient> client;  // nullopt: FortiAuth
+    std::string method, path;
+    Throttle::EndpointClass kind;
+    std::size_t response_reserve;
+    std::unique_ptr<FortiAPI::Transfer> transfer;
+
+    [[nodiscard]] std::shared_ptr<const ConfigSnapshot> settings() const {
+        return client ? client->config() : FortiAuth::snapshot();
+    }
+
+    void rebuild(std::shared_ptr<const ConfigSnapshot> config) {
+        transfer.reset();  // hands the old handle back before leasing one for the new settings
+        transfer = FortiAPI::prepare(std::move(config), method, path);
+        transfer->series = &Metrics::series_for(method, path);
+        transfer->body.reserve(response_reserve);
+    }
+
+public:
+    inline static std::size_t default_response_reserve = 16 * 1024;
+
+    PreparedRequest(std::string method, std::string path, std::size_t response_reserve = default_response_reserve)
+            : method(std::move(method)), path(std::move(path)), kind(Throttle::classify(this->method, this->path)),
+              response_reserve(response_reserve) {
+        if (auto active = FortiClient::current()) client = *active;
+        rebuild(settings());
+    }
+
+    PreparedRequest(const PreparedRequest&) = delete;
+    PreparedRequest& operator=(const PreparedRequest&) = delete;
+    PreparedRequest(PreparedRequest&&) noexcept = default;
+    PreparedRequest& operator=(PreparedRequest&&) noexcept = default;
+
+    /*
+     * Performs the request with `body` (ignored for GET and DELETE) and returns the HTTP status; the raw answer stays
+     * in response() until the next call.  Throttled, retried and recorded like FortiAPI::request, and writes drop the
+     * cached reads of their table once they complete.
+     */
+    long send(std::string_view body = {}) {
+        if (auto config = settings(); config != transfer->settings) rebuild(std::move(config));
+        CURL *curl = transfer->handle();
+
+        if (method == "POST" || method == "PUT") {
+            curl_easy_setopt(curl, CURLOPT_POSTFIELDS, body.empty() ? "" : body.data());
+            curl_easy_setopt(curl, CURLOPT_POSTFIELDSIZE_LARGE, static_cast<curl_off_t>(body.size()));
+        }
+
+        auto permit = Throttle::acquire(kind, transfer->settings->gateway);
+        for (unsigned int attempt = 1;; ++attempt) {
+            transfer->body.clear();
+            if (transfer->body.capacity() < response_reserve) transfer->body.reserve(response_reserve);
+
+            CURLcode res = curl_easy_perform(curl);
+            if (auto delay = FortiAPI::retry_delay(*transfer, res, attempt, permit)) {
+                std::this_thread::sleep_for(*delay);
+                continue;
+            }
+            permit.finish(curl, res);
+            FortiAPI::settle(*transfer, res);
+
+            long status = 0;
+            curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &status);
+            return status;
+        }
+    }
+
+    // send() and decode the answer; write acknowledgements that are not a success are reported like FortiAPI::post
+    template<typename T = Response>
+    T execute(std::string_view body = {}) {
+        send(body);
+        auto result = FortiAPI::decode<T>(*transfer, Metrics::enabled() ? transfer->series : nullptr);
+        if constexpr (std::is_same_v<T, Response>) if (method != "GET") return FortiAPI::report(std::move(result));
+        return result;
+    }
+
+    // the raw body of the last answer
+    [[nodiscard]] std::string_view response() const { return transfer->body; }
+
+    [[nodiscard]] const std::string& url() const { return transfer->url; }
+};
+
+#endif //FORTI_API_PREPARED_REQUEST_HPP
@@ -0,0 +1,135 @@
+#ifndef FORTI_API_QUERY_HPP
+#define FORTI_API_QUERY_HPP
+
+#include <cctype>
+#include <format>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "api.hpp"
+
+
+/*
+ * Typed builder for FortiOS `filter=` expressions over the mapped members of T.
+ *
+ *     auto query = Query<FirewallPolicy>().eq(&FirewallPolicy::name, "wan-in").ne(&FirewallPolicy::status, "disable");
+ *     auto policies = FortiAPI::get<FirewallPoliciesResponse>(query.apply("/cmdb/firewall/policy")).results;
+ *
+ * Every call adds one filter parameter (FortiOS ANDs them); any_of() ORs several values of one member inside a
+ * single parameter.  Values are percent-encoded, member names are resolved to their wire keys at compile time.
+ */
+template<typename T>
+class Query {
+    std::vector<std::string> filters;
+
+    static std::string encode(std::string_view value) {
+        static constexpr char hex[] = "0123456789ABCDEF";
+        std::string encoded;
+        encoded.reserve(value.size());
+        for (unsigned char c : value) {
+            if (std::isalnum(c) || c == '-' || c == '_' || c == '.' || c == '~') encoded.push_back(static_cast<char>(c));
+            else {
+                encoded.push_back('%');
+                encoded.push_back(hex[c >> 4]);
+                encoded.push_back(hex[c & 0x0F]);
+            }
+        }
+        return encoded;
+    }
+
+    template<typename M, typename C>
+    static std::string_view key(M C::* member) {
+        auto key = T::wire_key(member);
+        if (key.empty()) throw std::invalid_argument("Query on a member that is not part of the wire mapping");
+        return key;
+    }
+
+    template<typename M, typename C, typename V>
+    static std::string clause(M C::* member, std::string_view op, const V& value) {
+        return std::format("{}{}{}", key(member), op, encode(std::format("{}", value)));
+    }
+
+    template<typename M, typename C, typename V>
+    Query& add(M C::* member, std::string_view op, const V& value) {
+        filters.push_back(clause(member, op, value));
+        return *this;
+    }
+
+public:
+    template<typename M, typename C, typename V> Query& eq(M C::* member, const V& value) { return add(member, "==", value); }
+    template<typename M, typename C, typename V> Query& ne(M C::* member, const V& value) { return add(member, "!=", value); }
+    template<typename M, typename C, typename V> Query& contains(M C::* member, const V& value) { return add(member, "=@", value); }
+    template<typename M, typename C, typename V> Query& excludes(M C::* member, const V& value) { return add(member, "!@", value); }
+    template<typename M, typename C, typename V> Query& lt(M C::* member, const V& value) { return add(member, "<", value); }
+    template<typename M, typename C, typename V> Query& le(M C::* member, const V& value) { return add(member, "<=", value); }
+    template<typename M, typename C, typename V> Query& gt(M C::* member, const V& value) { return add(member, ">", value); }
+    template<typename M, typename C, typename V> Query& ge(M C::* member, const V& value) { return add(member, ">=", value); }
+
+    template<typename M, typename C, typename V>
+    Query& any_of(M C::* member, const std::vector<V>& values) {
+        std::string filter;
+        for (const auto& value : values) {
+            if (!filter.empty()) filter += ',';
+            filter += clause(member, "==", value);
+        }
+        if (!filter.empty()) filters.push_back(std::move(filter));
+        return *this;
+    }
+
+    [[nodiscard]] bool empty() const { return filters.empty(); }
+
+    [[nodiscard]] std::string str() const {
+        std::string query;
+        for (const auto& filter : filters) {
+            if (!query.empty()) query += '&';
+            query += "filter=" + filter;
+        }
+        return query;
+    }
+
+    [[nodiscard]] std::string apply(const std::string& path) const {
+        return empty() ? path : FortiAPI::append_query(path, str());
+    }
+};
+
+
+/*
+ * Compile-time `format=` projection: FortiOS only serialises the listed members and only those are decoded.
+ *
+ *     auto names = FortiGate::Policies::get<&FirewallPolicy::policyid, &FirewallPolicy::name>();
+ *
+ * CMDB tables are projected by their hyphenated wire keys; monitor endpoints report (and select) attributes by their
+ * underscore names, so apply() lists the verbatim member names for /monitor/ paths.
+ *
+ * Members left out of the projection decode to their defaults, so write projected objects back with a partial update
+ * (e.g. Policies::update(updated, original)) rather than a full PUT.
+ */
+template<typename T, auto... Members>
+class Projection {
+    static_assert(sizeof...(Members) > 0, "a projection needs at least one member");
+    static_assert((!T::wire_key(Members).empty() && ...), "projection on a member that is not part of the wire mapping");
+
+    template<bool Monitor>
+    [[nodiscard]] static const std::string& format() {
+        static const std::string format = [] {
+            std::string fields;
+            ((fields += fields.empty() ? "" : "|", fields += Monitor ? T::member_name(Members) : T::wire_key(Members)),
+             ...);
+            return "format=" + fields;
+        }();
+        return format;
+    }
+
+public:
+    // the CMDB form
+    [[nodiscard]] static const std::string& str() { return format<false>(); }
+
+    [[nodiscard]] static const std::string& monitor_str() { return format<true>(); }
+
+    [[nodiscard]] static std::string apply(const std::string& path) {
+        return FortiAPI::append_query(path, path.starts_with("/monitor/") ? monitor_str() : str());
+    }
+};
+
+#endif //FORTI_API_QUERY_HPP
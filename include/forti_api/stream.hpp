@@ -0,0 +1,205 @@
+#ifndef FORTI_API_STREAM_HPP
+#define FORTI_API_STREAM_HPP
+
+#include <algorithm>
+#include <cstddef>
+#include <format>
+#include <functional>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+#include <nlohmann/json.hpp>
+
+
+/*
+ * Push-style splitter for FortiOS responses.  Bytes are fed as they arrive from curl; every element of the array at
+ * `target` (e.g. {"results"} or {"results", "entries"}) is handed to `on_element` as soon as its closing byte was seen
+ * and then discarded.  Everything outside that array is kept as the envelope, with the array itself left empty.
+ *
+ * Neither the full body nor a DOM of it is ever held: peak memory is one element plus the envelope, and both are
+ * capped by `limit` bytes.  Without `on_element` the array is only skipped, and span() reports where it was.
+ */
+class JsonArrayStream {
+    struct Frame {
+        bool is_object{}, on_path{};
+        std::string key;
+    };
+
+    std::vector<std::string> target;
+    std::function<void(std::string_view)> on_element;
+    std::size_t limit;
+
+    std::vector<Frame> frames;
+    std::string envelope, element, key;
+    bool in_string = false, escaped = false, reading_key = false, expect_key = false;
+
+    // nesting depth inside the current element of the target array
+    std::size_t element_depth = 0;
+    bool in_target = false, element_open = false;
+
+    // byte offsets of the target array's '[' and one past its ']' in everything fed so far
+    std::size_t offset = 0, span_begin = std::string::npos, span_end = std::string::npos;
+
+    void append(std::string& buffer, char c) const {
+        if (buffer.size() >= limit)
+            throw std::length_error(std::format("Streamed JSON element exceeds buffer limit of {} bytes", limit));
+        buffer.push_back(c);
+    }
+
+    void keep(char c) {
+        if (on_element) append(element, c);
+    }
+
+    void emit() {
+        if (on_element && !element.empty()) on_element(element);
+        element.clear();
+        element_open = false;
+    }
+
+    void consume_target(char c) {
+        if (in_string) {
+            keep(c);
+            if (escaped) escaped = false;
+            else if (c == '\\') escaped = true;
+            else if (c == '"') in_string = false;
+            return;
+        }
+
+        switch (c) {
+            case '"':
+                in_string = true;
+                element_open = true;
+                keep(c);
+                return;
+            case '{':
+            case '[':
+                ++element_depth;
+                element_open = true;
+                keep(c);
+                return;
+            case '}':
+            case ']':
+                if (element_depth == 0) {  // closing bracket of the target array itself
+                    if (element_open) emit();
+                    in_target = false;
+                    span_end = offset + 1;
+                    frames.pop_back();
+                    append(envelope, ']');
+                    return;
+                }
+                --element_depth;
+                keep(c);
+                return;
+            case ',':
+                if (element_depth == 0) emit();
+                else keep(c);
+                return;
+            case ' ': case '\n': case '\r': case '\t':
+                if (element_depth > 0) keep(c);
+                return;
+            default:
+                element_open = true;
+                keep(c);
+        }
+    }
+
+    void consume_envelope(char c) {
+        append(envelope, c);
+
+        if (in_string) {
+            if (escaped) escaped = false;
+            else if (c == '\\') escaped = true;
+            else if (c == '"') {
+                in_string = false;
+                if (reading_key) {
+                    frames.back().key = key;
+                    reading_key = false;
+                }
+            } else if (reading_key) key.push_back(c);
+            return;
+        }
+
+        switch (c) {
+            case '"':
+                in_string = true;
+                if (!frames.empty() && frames.back().is_object && expect_key) {
+                    reading_key = true;
+                    key.clear();
+                }
+                return;
+            case ':':
+                expect_key = false;
+                return;
+            case ',':
+                expect_key = !frames.empty() && frames.back().is_object;
+                return;
+            case '{':
+            case '[': {
+                bool on_path = frames.empty() ||
+                               (frames.back().on_path && frames.back().is_object && frames.size() <= target.size() &&
+                                frames.back().key == target[frames.size() - 1]);
+                frames.push_back({c == '{', on_path, {}});
+                expect_key = c == '{';
+                if (c == '[' && on_path && frames.size() == target.size() + 1) {
+                    in_target = true;
+                    span_begin = offset;
+                }
+                return;
+            }
+            case '}':
+            case ']':
+                if (!frames.empty()) frames.pop_back();
+                expect_key = false;
+                return;
+            default:
+                return;
+        }
+    }
+
+public:
+    inline static std::size_t default_limit = 1 << 20;
+
+    JsonArrayStream(std::vector<std::string> target, std::function<void(std::string_view)> on_element,
+                    std::size_t limit = default_limit) :
+            target(std::move(target)), on_element(std::move(on_element)), limit(limit) {}
+
+    void feed(std::string_view bytes) {
+        for (char c : bytes) {
+            if (in_target) consume_target(c);
+            else consume_envelope(c);
+            ++offset;
+        }
+    }
+
+    // the response with the streamed array left empty; only valid once the transfer completed
+    [[nodiscard]] const std::string& remainder() const { return envelope; }
+
+    // [begin, end) of the target array including its brackets, npos when there was none
+    [[nodiscard]] std::pair<std::size_t, std::size_t> span() const { return {span_begin, span_end}; }
+
+    struct Split {
+        std::string envelope;
+        std::size_t begin = std::string::npos, end = std::string::npos;
+    };
+
+    // one pass over a complete body: the envelope without the target array, plus where the array lies in `body`
+    static Split split(std::string_view body, std::vector<std::string> target = {"results"}) {
+        JsonArrayStream stream(std::move(target), nullptr, body.size() + 1);
+        stream.envelope.reserve(std::min<std::size_t>(body.size(), 4096));  // envelopes are small, bodies may not be
+        stream.feed(body);
+        return {std::move(stream.envelope), stream.span_begin, stream.span_end};
+    }
+};
+
+
+// decodes each streamed element straight into T and passes it to the sink
+template<typename T, typename Sink>
+struct StreamDecoder {
+    Sink sink;
+
+    void operator()(std::string_view element) { sink(nlohmann::json::parse(element).template get<T>()); }
+};
+
+#endif //FORTI_API_STREAM_HPP
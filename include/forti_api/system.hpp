@@ -6,6 +6,9 @@
 #define FORTI_API_SYSTEM_H
 
 #include "api.hpp"
+#include "query.hpp"
+#include "interface_cache.hpp"
+#include <future>
 #include <string>
 #include <utility>
 #include <algorithm>
@@ -18,29 +21,6 @@ namespace System {
     class Interface {
         inline static std::string available_interfaces_endpoint = "/monitor/system/available-interfaces";
 
-        inline static std::vector<SystemInterface> physical_interfaces{},
-                tunnel_interfaces{},
-                hard_switch_vlan_interfaces{},
-                aggregate_interfaces{};
-
-        static void update_local_interface_data() {
-            physical_interfaces.clear();
-            tunnel_interfaces.clear();
-            hard_switch_vlan_interfaces.clear();
-            aggregate_interfaces.clear();
-
-            auto interfaces = FortiAPI::get<InterfacesGeneralResponse>(available_interfaces_endpoint);
-            for (const auto& interface : interfaces.results) {
-                if (!interface.contains("type")) continue;
-                auto type = interface["type"].get<std::string>();
-
-                if (type == "physical") physical_interfaces.emplace_back(interface);
-                else if (type == "tunnel") tunnel_interfaces.emplace_back(interface);
-                else if (type == "hard-switch-vlan") hard_switch_vlan_interfaces.emplace_back(interface);
-                else if (type == "aggregate") aggregate_interfaces.emplace_back(interface);
-            }
-        }
-
         static unsigned int count_interfaces() {
             return FortiAPI::get<GeneralResponse>(available_interfaces_endpoint).results.size();
         }
@@ -52,29 +32,40 @@ namespace System {
             return FortiAPI::get<std::vector<nlohmann::json>>(endpoint)[0];
         }
 
-        static SystemInterface get(const std::vector<SystemInterface>& interfaces,
-                                   const std::string& name, const std::string& vdom = "root") {
-            if (interfaces.empty()) update_local_interface_data();
-            for (const auto& interface : interfaces)
-                if (interface.name == name && interface.vdom == vdom) return interface;
-            throw std::runtime_error(std::format("No system interface found for: {}", name));
+        static SystemInterface find(std::string_view type, const std::string& name, const std::string& vdom = "root") {
+            auto interface = InterfaceCache::snapshot()->find(name, vdom);
+            if (!interface || interface->type != type)
+                throw std::runtime_error(std::format("No system interface found for: {}", name));
+            return *interface;
         }
 
     public:
         static SystemInterface get_physical_interface(const std::string& name, const std::string& vdom = "root") {
-            return get(physical_interfaces, name, vdom);
+            return find("physical", name, vdom);
         }
 
         static SystemInterface get_tunnel_interface(const std::string& name, const std::string& vdom = "root") {
-            return get(tunnel_interfaces, name, vdom);
+            return find("tunnel", name, vdom);
         }
 
         static SystemInterface get_hard_vlan_switch_interface(const std::string& name, const std::string& vdom = "root") {
-            return get(hard_switch_vlan_interfaces, name, vdom);
+            return find("hard-switch-vlan", name, vdom);
         }
 
         static SystemInterface get_aggregate_interface(const std::string& name, const std::string& vdom = "root") {
-            return get(aggregate_interfaces, name, vdom);
+            return find("aggregate", name, vdom);
+        }
+
+        // only the listed members are requested and decoded, e.g. get<&SystemInterface::name, &SystemInterface::status>()
+        template<auto Member, auto... Members>
+        static std::vector<SystemInterface> get(const std::string& vdom = "root") {
+            auto path = std::format("{}?vdom={}", available_interfaces_endpoint, vdom);
+            return FortiAPI::get<SystemInterfacesResponse>(Projection<SystemInterface, Member, Members...>::apply(path)).results;
+        }
+
+        // every cached interface of one type ("physical", "tunnel", "aggregate", ...)
+        static std::vector<SystemInterface> get_interfaces(const std::string& type) {
+            return InterfaceCache::snapshot()->of_type(type);
         }
 
         static VirtualWANLink get_virtual_wan_link(const std::string& name = "virtual-wan-link", const std::string& vdom = "root") {
@@ -84,6 +75,14 @@ namespace System {
         static std::string get_wan_ip(unsigned int wan_port = 1, const std::string& vdom = "root") {
             return get_physical_interface(std::format("wan{}", wan_port), vdom).ipv4_addresses[0].ip;
         }
+
+        static std::future<VirtualWANLink> get_virtual_wan_link_async(const std::string& name = "virtual-wan-link",
+                                                                      const std::string& vdom = "root") {
+            auto endpoint = std::format("{}?vdom={}&mkey={}", available_interfaces_endpoint, vdom, name);
+            return FortiAPI::get_async<std::vector<nlohmann::json>>(endpoint, [](std::vector<nlohmann::json> results) {
+                return results.at(0).get<VirtualWANLink>();
+            });
+        }
     }; // System::Interface
 
     class Admin {
@@ -110,6 +109,19 @@ namespace System {
                 if (response.status == "success") return response.results[0];
                 else throw std::runtime_error("API Admin user " + api_admin_name + " not found...");
             }
+
+            static std::future<std::vector<APIUser>> get_async() {
+                return FortiAPI::get_async<AllAPIUsersResponse>(api_user_endpoint,
+                        [](AllAPIUsersResponse response) { return std::move(response.results); });
+            }
+
+            static std::future<APIUser> get_async(const std::string& api_admin_name) {
+                auto endpoint = std::format("{}/{}", api_user_endpoint, api_admin_name);
+                return FortiAPI::get_async<AllAPIUsersResponse>(endpoint, [api_admin_name](AllAPIUsersResponse response) {
+                    if (response.status == "success") return std::move(response.results[0]);
+                    else throw std::runtime_error("API Admin user " + api_admin_name + " not found...");
+                });
+            }
         };
     };
 
@@ -6,9 +6,13 @@
 #define FORTI_API_THREAT_FEED_HPP
 
 #include "dns_filter.hpp"
+#include <future>
 #include <utility>
 #include <vector>
 #include "api.hpp"
+#include "bulk.hpp"
+#include "paginated.hpp"
+#include "query.hpp"
 #include "types/threat_feed/ext_connector.h"
 
 
@@ -26,16 +30,30 @@ class ThreatFeed {
     }
 
 public:
+    // raw payload: keys may use either spelling ("update_method" is sent as "update-method")
     static void update_info(const std::string& name, const nlohmann::json& data) {
         FortiAPI::post(std::format("{}/{}", external_resource_monitor, name), data);
     }
 
-    static void update_feed(const CommandsRequest& data) { FortiAPI::post(external_resource_monitor, data); }
+    // streamed straight from `data`, so pushing millions of entries never builds the JSON document in memory
+    static Response update_feed(const CommandsRequest& data) {
+        CommandsBodyWriter body(data);
+        return FortiAPI::post(external_resource_monitor, body);
+    }
 
     static std::vector<PushThreatFeed> get() {
         return FortiAPI::get<ExternalResourcesResponse>(external_resource).results;
     }
 
+    static std::vector<PushThreatFeed> get(const Query<PushThreatFeed>& query) {
+        return FortiAPI::get<ExternalResourcesResponse>(query.apply(external_resource)).results;
+    }
+
+    static Paginated<PushThreatFeed, ExternalResourcesResponse> paged(
+            std::size_t page_size = Paginated<PushThreatFeed, ExternalResourcesResponse>::default_page_size) {
+        return {external_resource, page_size};
+    }
+
     static PushThreatFeed get(const std::string& query) {
         return FortiAPI::get<ExternalResourcesResponse>(std::format("{}/{}", external_resource, query)).results[0];
     }
@@ -45,8 +63,15 @@ public:
                 (std::format("{}/{}", external_resource_entry_list, feed)).results.entries;
     }
 
+    // streams a (potentially huge) entry list without ever holding the whole body or its DOM
+    template<typename F>
+    static Response for_each_entry(const std::string& feed, F fn) {
+        return FortiAPI::stream<Entry>(std::format("{}/{}", external_resource_entry_list, feed),
+                                       {"results", "entries"}, std::move(fn));
+    }
+
     static bool contains(const std::string& name) {
-        return FortiAPI::get<ExternalResourcesResponse>(std::format("{}/{}", external_resource, name)).http_status == 200;
+        return FortiAPI::get<LazyResponse<PushThreatFeed>>(std::format("{}/{}", external_resource, name)).http_status == 200;
     }
 
     static void enable(const std::string& name) { set(name, true); }
@@ -58,6 +83,34 @@ public:
         FortiAPI::post(external_resource, threat_feed);
     }
 
+    static std::future<Response> update_feed_async(const CommandsRequest& data) {
+        return FortiAPI::post_async(external_resource_monitor, data);
+    }
+
+    static std::future<std::vector<PushThreatFeed>> get_async() {
+        return FortiAPI::get_async<ExternalResourcesResponse>(external_resource,
+                [](ExternalResourcesResponse response) { return std::move(response.results); });
+    }
+
+    static std::future<PushThreatFeed> get_async(const std::string& query) {
+        return FortiAPI::get_async<ExternalResourcesResponse>(std::format("{}/{}", external_resource, query),
+                [](ExternalResourcesResponse response) { return std::move(response.results.at(0)); });
+    }
+
+    static std::future<std::vector<Entry>> get_entry_list_async(const std::string& feed) {
+        return FortiAPI::get_async<ExternalResourceEntryListResponse>(std::format("{}/{}", external_resource_entry_list, feed),
+                [](ExternalResourceEntryListResponse response) { return std::move(response.results.entries); });
+    }
+
+    static std::future<bool> contains_async(const std::string& name) {
+        return FortiAPI::get_async<LazyResponse<PushThreatFeed>>(std::format("{}/{}", external_resource, name),
+                [](const LazyResponse<PushThreatFeed>& response) { return response.http_status == 200; });
+    }
+
+    static std::future<Response> add_async(const std::string& name, unsigned int category) {
+        return FortiAPI::post_async(external_resource, PushThreatFeed(name, category));
+    }
+
     static void del(const std::string& name) {
         if (contains(name)) {
             auto category = get(name).category;
@@ -66,11 +119,17 @@ public:
         } else std::cerr << "Couldn't locate threat feed for deletion: " << name << std::endl;
     }
 
-    static void del(unsigned int category) {
-        DNSFilter::global_allow_category(category);
-        for (const auto& feed : get()) {
-            if (feed.category == category) FortiAPI::del(std::format("{}/{}", external_resource, feed.name));
-        }
+    // releases the category in every DNS profile first, then removes all feeds using it, both fanned out in parallel
+    static BulkResult del(unsigned int category, std::size_t concurrency = Bulk::max_concurrency) {
+        auto result = DNSFilter::global_allow_category(category, concurrency);
+
+        auto feeds = get(Query<PushThreatFeed>().eq(&PushThreatFeed::category, category));
+
+        auto path = [](const PushThreatFeed& feed) { return std::format("{}/{}", external_resource, feed.name); };
+        result.merge(Bulk::apply(feeds, path, [&path](const PushThreatFeed& feed) {
+            return FortiAPI::del_async(path(feed));
+        }, concurrency));
+        return result;
     }
 };
 
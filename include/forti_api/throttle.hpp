@@ -0,0 +1,221 @@
+#ifndef FORTI_API_THROTTLE_HPP
+#define FORTI_API_THROTTLE_HPP
+
+#include <curl/curl.h>
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <string>
+#include <string_view>
+#include <utility>
+
+
+/*
+ * Client-side admission control so bulk work backs off before the FortiGate management plane falls over.
+ *
+ * Every request belongs to an endpoint class (CMDB reads, CMDB writes, monitor calls) of one gateway, each with its
+ * own token bucket (`rate` requests per second, bursts of up to `burst`) and an adaptive concurrency limit.  The limit
+ * follows AIMD: it grows by 1/limit per healthy response and is cut by `decrease` whenever the box answers 429/5xx,
+ * times out, or takes longer than `latency_target` to start responding, never leaving [min_concurrency,
+ * max_concurrency].
+ *
+ * Idempotent GETs that fail that way are retried by FortiAPI up to `retry.max_attempts` times with full-jitter
+ * exponential backoff, honouring Retry-After when the FortiGate sends one.
+ */
+class Throttle {
+public:
+    enum class EndpointClass : std::size_t { CmdbRead, CmdbWrite, Monitor };
+
+    struct Limits {
+        double rate = 0;  // requests per second, 0 disables the token bucket
+        double burst = 10;
+        double min_concurrency = 1, max_concurrency = 16;
+        double decrease = 0.7;
+        std::chrono::milliseconds latency_target{3000};
+    };
+
+    struct RetryPolicy {
+        unsigned int max_attempts = 4;
+        std::chrono::milliseconds base{200}, cap{10000};
+    };
+
+private:
+    struct Gate {
+        std::mutex mutex;
+        std::condition_variable released;
+        Limits limits;
+        double tokens = 0, limit = 0;
+        unsigned int in_flight = 0;
+        std::chrono::steady_clock::time_point refilled = std::chrono::steady_clock::now();
+
+        explicit Gate(Limits limits) : limits(limits), tokens(limits.burst), limit(limits.max_concurrency) {}
+    };
+
+    struct Gates {
+        std::array<Gate, 3> by_class;
+
+        explicit Gates(const std::array<Limits, 3>& limits)
+                : by_class{Gate(limits[0]), Gate(limits[1]), Gate(limits[2])} {}
+    };
+
+    // limits for gates created from now on; configure() also applies them to the existing ones
+    inline static std::array<Limits, 3> defaults = {Limits{0, 10, 1, 16, 0.7, std::chrono::milliseconds(3000)},
+                                                    Limits{0, 4, 1, 4, 0.5, std::chrono::milliseconds(5000)},
+                                                    Limits{0, 10, 1, 8, 0.7, std::chrono::milliseconds(3000)}};
+    inline static std::mutex gates_mutex;
+    inline static std::map<std::string, std::unique_ptr<Gates>, std::less<>> gates;  // per gateway, never freed
+
+    static Gate& gate(EndpointClass kind, std::string_view gateway = {}) {
+        std::lock_guard lock(gates_mutex);
+        auto it = gates.find(gateway);
+        if (it == gates.end()) it = gates.emplace(std::string(gateway), std::make_unique<Gates>(defaults)).first;
+        return it->second->by_class[static_cast<std::size_t>(kind)];
+    }
+
+    static void refill(Gate& gate) {
+        auto now = std::chrono::steady_clock::now();
+        if (gate.limits.rate > 0) {
+            double elapsed = std::chrono::duration<double>(now - gate.refilled).count();
+            gate.tokens = std::min(gate.limits.burst, gate.tokens + elapsed * gate.limits.rate);
+        }
+        gate.refilled = now;
+    }
+
+public:
+    inline static RetryPolicy retry{4, std::chrono::milliseconds(200), std::chrono::milliseconds(10000)};
+
+    // holds one concurrency slot of its endpoint class until finished or destroyed
+    class Permit {
+        Gate* gate = nullptr;
+
+    public:
+        Permit() = default;
+        explicit Permit(Gate* gate) : gate(gate) {}
+        Permit(const Permit&) = delete;
+        Permit& operator=(const Permit&) = delete;
+        Permit(Permit&& other) noexcept : gate(std::exchange(other.gate, nullptr)) {}
+        Permit& operator=(Permit&& other) noexcept {
+            if (this != &other) {
+                release();
+                gate = std::exchange(other.gate, nullptr);
+            }
+            return *this;
+        }
+        ~Permit() { release(); }
+
+        // feed the outcome of an attempt into the AIMD limit without giving up the slot (used between retries)
+        void observe(CURL* handle, CURLcode result) const {
+            if (!gate) return;
+            long status = 0;
+            curl_off_t start_transfer = 0;
+            curl_easy_getinfo(handle, CURLINFO_RESPONSE_CODE, &status);
+            curl_easy_getinfo(handle, CURLINFO_STARTTRANSFER_TIME_T, &start_transfer);
+
+            bool slow = std::chrono::microseconds(start_transfer) > gate->limits.latency_target;
+            std::lock_guard lock(gate->mutex);
+            if (congested(result, status) || slow)
+                gate->limit = std::max(gate->limits.min_concurrency, gate->limit * gate->limits.decrease);
+            else gate->limit = std::min(gate->limits.max_concurrency, gate->limit + 1.0 / gate->limit);
+        }
+
+        void finish(CURL* handle, CURLcode result) {
+            observe(handle, result);
+            release();
+        }
+
+        void release() {
+            if (!gate) return;
+            {
+                std::lock_guard lock(gate->mutex);
+                --gate->in_flight;
+            }
+            gate->released.notify_all();
+            gate = nullptr;
+        }
+    };
+
+    static EndpointClass classify(std::string_view method, std::string_view path) {
+        if (path.starts_with("/monitor/")) return EndpointClass::Monitor;
+        return method == "GET" ? EndpointClass::CmdbRead : EndpointClass::CmdbWrite;
+    }
+
+    // applies to the class on every gateway, current and future
+    static void configure(EndpointClass kind, Limits limits) {
+        std::lock_guard gates_lock(gates_mutex);
+        defaults[static_cast<std::size_t>(kind)] = limits;
+        for (auto& [gateway, per_gateway] : gates) {
+            auto& target = per_gateway->by_class[static_cast<std::size_t>(kind)];
+            {
+                std::lock_guard lock(target.mutex);
+                target.limits = limits;
+                target.tokens = std::min(target.tokens, limits.burst);
+                target.limit = std::clamp(target.limit, limits.min_concurrency, limits.max_concurrency);
+            }
+            target.released.notify_all();
+        }
+    }
+
+    static Limits limits(EndpointClass kind) {
+        std::lock_guard lock(gates_mutex);
+        return defaults[static_cast<std::size_t>(kind)];
+    }
+
+    static double concurrency_limit(EndpointClass kind, std::string_view gateway = {}) {
+        auto& target = gate(kind, gateway);
+        std::lock_guard lock(target.mutex);
+        return target.limit;
+    }
+
+    // blocks until the class has both a token and a free concurrency slot on `gateway`
+    static Permit acquire(EndpointClass kind, std::string_view gateway = {}) {
+        auto& target = gate(kind, gateway);
+        std::unique_lock lock(target.mutex);
+        while (true) {
+            refill(target);
+            bool slot = target.in_flight < static_cast<unsigned int>(std::max(1.0, target.limit));
+            bool token = target.limits.rate <= 0 || target.tokens >= 1;
+            if (slot && token) break;
+
+            if (!slot) target.released.wait(lock);
+            else target.released.wait_for(lock,
+                                          std::chrono::duration<double>((1 - target.tokens) / target.limits.rate));
+        }
+        if (target.limits.rate > 0) target.tokens -= 1;
+        ++target.in_flight;
+        return Permit(&target);
+    }
+
+    // the management plane is pushing back (or unreachable): worth slowing down and, for GETs, retrying
+    static bool congested(CURLcode result, long status) {
+        switch (result) {
+            case CURLE_OK:
+                return status == 429 || status >= 500;
+            case CURLE_OPERATION_TIMEDOUT:
+            case CURLE_COULDNT_CONNECT:
+            case CURLE_SEND_ERROR:
+            case CURLE_RECV_ERROR:
+            case CURLE_GOT_NOTHING:
+            case CURLE_PARTIAL_FILE:
+                return true;
+            default:
+                return false;
+        }
+    }
+
+    // full jitter: uniform in [0, min(cap, base * 2^(attempt-1))], but not sooner than Retry-After (up to cap)
+    static std::chrono::milliseconds backoff(unsigned int attempt, long long retry_after_seconds = 0) {
+        thread_local std::mt19937 random{std::random_device{}()};
+        auto cap = retry.cap.count();
+        auto ceiling = std::min<long long>(cap, retry.base.count() << std::min(attempt - 1, 20u));
+        auto delay = std::uniform_int_distribution<long long>(0, std::max<long long>(ceiling, 0))(random);
+        return std::chrono::milliseconds(std::max(delay, std::min<long long>(retry_after_seconds * 1000, cap)));
+    }
+};
+
+#endif //FORTI_API_THROTTLE_HPP
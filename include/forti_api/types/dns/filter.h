@@ -5,6 +5,17 @@
 #ifndef FORTI_API_FILTER_H
 #define FORTI_API_FILTER_H
 
+#include <algorithm>
+#include <bitset>
+#include <cstddef>
+#include <cstdint>
+#include <format>
+#include <initializer_list>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
 #include "nlohmann/json.hpp"
 #include "../response.h"
 
@@ -16,55 +27,186 @@ struct Filter {
     explicit Filter(unsigned int category, std::string  action = "allow") :
             category(category), action(std::move(action)) {}
 
-    NLOHMANN_DEFINE_TYPE_INTRUSIVE_WITH_DEFAULT(Filter, id, q_origin_key, category, action, log)
-};
-
-struct CompareFilters {
-    bool operator()(const Filter& a, const Filter& b) const { return a.category < b.category; }
-    bool operator()(const Filter& a, unsigned int category) const { return a.category < category; }
-    bool operator()(unsigned int category, const Filter& b) const { return category < b.category; }
+    FORTI_API_DEFINE_TYPE_INTRUSIVE_WITH_DEFAULT(Filter, id, q_origin_key, category, action, log)
 };
 
+/*
+ * FortiGuard category filters of a DNS profile ("ftgd-dns"), held as one bitset per action instead of a list of
+ * Filter rows.  Single-category edits are a couple of bit flips and bulk edits (a whole category set, or the union or
+ * intersection with another profile) are word-wide bit operations.  The wire `filters` array is only decoded when a
+ * profile is read and rebuilt, in category order, when it is written; filter ids FortiOS assigned are kept, new
+ * filters are sent with id 0 so FortiOS numbers them.
+ *
+ * A category without a filter follows FortiGuard's default, so allow() drops the filter rather than adding one.
+ * Rows this model can't hold (an action added by a newer FortiOS, or a category past `category_limit`) are kept verbatim
+ * and written back unchanged after the others, until an edit to their category replaces them.
+ */
 struct DNSFilterOptions {
+    static constexpr std::size_t category_limit = 256;
+    using Categories = std::bitset<category_limit>;
+
     std::string options;
-    std::vector<Filter> filters;
 
-    NLOHMANN_DEFINE_TYPE_INTRUSIVE_WITH_DEFAULT(DNSFilterOptions, options, filters)
+private:
+    Categories blocking, monitoring, allowing, logging;
+    std::vector<std::pair<std::uint16_t, std::uint16_t>> ids;  // (category, id) as received, sorted by category
+    std::vector<nlohmann::json> unknown;  // rows passed through as received
 
-    std::pair<bool, unsigned int> find_category(unsigned int category) {
-        auto it = std::lower_bound(filters.begin(), filters.end(), category, CompareFilters());
-        if (it != filters.end() && it->category == category) {
-            return std::make_pair(true, std::distance(filters.begin(), it));
-        }
-        return std::make_pair(false, std::distance(filters.begin(), it));
+    static std::size_t index(unsigned int category) {
+        if (category >= category_limit)
+            throw std::out_of_range(std::format("FortiGuard category out of range: {}", category));
+        return category;
+    }
+
+    void drop_unknown(const Categories& selected) {
+        std::erase_if(unknown, [&selected](const nlohmann::json& row) {
+            auto category = row.value("category", 0u);
+            return category < category_limit && selected.test(category);
+        });
+    }
+
+    // a new filter logs by default, an existing one keeps its setting
+    void set(Categories& action, const Categories& selected) {
+        drop_unknown(selected);
+        logging |= selected & ~categories();
+        blocking &= ~selected;
+        monitoring &= ~selected;
+        allowing &= ~selected;
+        action |= selected;
+    }
+
+    [[nodiscard]] unsigned int id_of(unsigned int category) const {
+        auto it = std::lower_bound(ids.begin(), ids.end(), std::make_pair(static_cast<std::uint16_t>(category),
+                                                                          std::uint16_t{0}));
+        return it != ids.end() && it->first == category ? it->second : 0;
+    }
+
+public:
+    static Categories categories_of(std::initializer_list<unsigned int> categories) {
+        Categories set;
+        for (auto category : categories) set.set(index(category));
+        return set;
+    }
+
+    void block(unsigned int category) { block(Categories().set(index(category))); }
+    void monitor(unsigned int category) { monitor(Categories().set(index(category))); }
+    void allow(unsigned int category) { allow(Categories().set(index(category))); }
+
+    void block(const Categories& categories) { set(blocking, categories); }
+    void monitor(const Categories& categories) { set(monitoring, categories); }
+
+    void allow(const Categories& categories) {
+        drop_unknown(categories);
+        blocking &= ~categories;
+        monitoring &= ~categories;
+        allowing &= ~categories;
+        logging &= ~categories;
     }
 
-    bool contains(unsigned int category) { return find_category(category).first; }
+    void set_log(unsigned int category, bool enabled) {
+        if (contains(category)) logging.set(category, enabled);
+    }
+
+    // categories with a filter, and those per action (allowed() only holds explicit "allow" filters)
+    [[nodiscard]] Categories categories() const { return blocking | monitoring | allowing; }
+    [[nodiscard]] const Categories& blocked() const { return blocking; }
+    [[nodiscard]] const Categories& monitored() const { return monitoring; }
+    [[nodiscard]] const Categories& allowed() const { return allowing; }
+    [[nodiscard]] const Categories& logged() const { return logging; }
+
+    [[nodiscard]] bool contains(unsigned int category) const {
+        return category < category_limit && categories().test(category);
+    }
+
+    // "block", "monitor", "allow", or empty when the category has no filter
+    [[nodiscard]] std::string_view action(unsigned int category) const {
+        if (category >= category_limit) return {};
+        if (blocking.test(category)) return "block";
+        if (monitoring.test(category)) return "monitor";
+        if (allowing.test(category)) return "allow";
+        return {};
+    }
+
+    // every category filtered by either profile, with the stricter action (block > monitor > allow)
+    void unite(const DNSFilterOptions& other) {
+        blocking |= other.blocking;
+        monitoring = (monitoring | other.monitoring) & ~blocking;
+        allowing = (allowing | other.allowing) & ~(blocking | monitoring);
+        logging |= other.logging;
+    }
 
-    void block(unsigned int category) {
-        const auto& [match_found, index] = find_category(category);
-        if (match_found) filters[index].action = "block";
-        else filters.emplace(filters.begin() + index, category, "block");
+    // only categories filtered by both profiles, with the more permissive of the two actions
+    void intersect(const DNSFilterOptions& other) {
+        auto common = categories() & other.categories();
+        auto restricted = (blocking | monitoring) & (other.blocking | other.monitoring);
+        blocking &= other.blocking;
+        monitoring = restricted & ~blocking;
+        allowing = common & ~restricted;
+        logging &= other.logging;
     }
 
-    void allow(unsigned int category) {
-        const auto& [match_found, index] = find_category(category);
-        if (match_found) filters.erase(filters.begin() + index);
+    // the wire rows, in category order
+    [[nodiscard]] std::vector<Filter> filters() const {
+        std::vector<Filter> rows;
+        rows.reserve(categories().count());
+        for (unsigned int category = 0; category < category_limit; ++category) {
+            auto name = action(category);
+            if (name.empty()) continue;
+            auto& row = rows.emplace_back(category, std::string(name));
+            row.id = row.q_origin_key = id_of(category);
+            row.log = logging.test(category) ? "enable" : "disable";
+        }
+        return rows;
+    }
+
+    // same options and filters; filter ids are ignored
+    bool operator==(const DNSFilterOptions& other) const {
+        return options == other.options && blocking == other.blocking && monitoring == other.monitoring &&
+               allowing == other.allowing && logging == other.logging && unknown == other.unknown;
     }
 
-    void monitor(unsigned int category) {
-        const auto& [match_found, index] = find_category(category);
-        if (match_found) filters[index].action = "monitor";
-        else filters.emplace(filters.begin() + index, category, "monitor");
+    friend void to_json(nlohmann::json& j, const DNSFilterOptions& o) {
+        j = nlohmann::json::object();
+        j["options"] = o.options;
+        j["filters"] = o.filters();
+        for (const auto& row : o.unknown) j["filters"].push_back(row);
     }
 
-    void sort_filters() { std::sort(filters.begin(), filters.end(), CompareFilters()); }
+    friend void from_json(const nlohmann::json& j, DNSFilterOptions& o) {
+        o = {};
+        if (auto it = j.find("options"); it != j.end()) it->get_to(o.options);
+        auto filters = j.find("filters");
+        if (filters == j.end()) return;
+
+        o.ids.reserve(filters->size());
+        for (const auto& row : *filters) {
+            auto category = row.value("category", 0u);
+            auto action = row.value("action", std::string("monitor"));
+            if (category >= category_limit) {
+                o.unknown.push_back(row);
+                continue;
+            }
+
+            if (action == "block") o.blocking.set(category);
+            else if (action == "monitor") o.monitoring.set(category);
+            else if (action == "allow") o.allowing.set(category);
+            else {
+                o.unknown.push_back(row);
+                continue;
+            }
+
+            o.logging.set(category, row.value("log", std::string("enable")) == "enable");
+            if (auto id = row.value("id", 0u))
+                o.ids.emplace_back(static_cast<std::uint16_t>(category), static_cast<std::uint16_t>(id));
+        }
+        std::sort(o.ids.begin(), o.ids.end());
+    }
 };
 
 struct DomainFilter {
     unsigned int domain_filter_table = 2;
 
-    NLOHMANN_DEFINE_TYPE_INTRUSIVE_WITH_DEFAULT(DomainFilter, domain_filter_table)
+    FORTI_API_DEFINE_TYPE_INTRUSIVE_WITH_DEFAULT(DomainFilter, domain_filter_table)
 };
 
 struct DNSProfile {
@@ -89,9 +231,9 @@ struct DNSProfile {
     void block_category(unsigned int category) { ftgd_dns.block(category); }
     void allow_category(unsigned int category) { ftgd_dns.allow(category); }
     void monitor_category(unsigned int category) { ftgd_dns.monitor(category); }
-    bool contains_category(unsigned int category) { return ftgd_dns.contains(category); }
+    [[nodiscard]] bool contains_category(unsigned int category) const { return ftgd_dns.contains(category); }
 
-    NLOHMANN_DEFINE_TYPE_INTRUSIVE_WITH_DEFAULT(DNSProfile, name, q_origin_key, comment, sdns_ftgd_err_log,
+    FORTI_API_DEFINE_TYPE_INTRUSIVE_WITH_DEFAULT(DNSProfile, name, q_origin_key, comment, sdns_ftgd_err_log,
             sdns_domain_log, block_action, redirect_portal, redirect_portal6,
             block_botnet, safe_search, youtube_restrict, log_all_domain,
             domain_filter, external_ip_blocklist, dns_translation, ftgd_dns)
@@ -101,7 +243,7 @@ struct DNSProfile {
 struct DNSFiltersResponse : public Response {
     std::vector<DNSFilterOptions> results;
 
-    NLOHMANN_DEFINE_TYPE_INTRUSIVE_WITH_DEFAULT(DNSFiltersResponse, http_method, size, matched_count, next_idx,
+    FORTI_API_DEFINE_TYPE_INTRUSIVE_WITH_DEFAULT(DNSFiltersResponse, http_method, size, matched_count, next_idx,
             revision, vdom, path, name, status, http_status, serial, version,
             build, results)
 };
@@ -109,7 +251,7 @@ struct DNSFiltersResponse : public Response {
 struct DNSProfilesResponse : public Response {
     std::vector<DNSProfile> results;
 
-    NLOHMANN_DEFINE_TYPE_INTRUSIVE_WITH_DEFAULT(DNSProfilesResponse, http_method, size, matched_count, next_idx,
+    FORTI_API_DEFINE_TYPE_INTRUSIVE_WITH_DEFAULT(DNSProfilesResponse, http_method, size, matched_count, next_idx,
             revision, vdom, path, name, status, http_status, serial, version,
             build, results)
 };
@@ -0,0 +1,98 @@
+#ifndef FORTI_API_EDITABLE_H
+#define FORTI_API_EDITABLE_H
+
+#include <memory>
+#include <optional>
+#include <string>
+#include "nlohmann/json.hpp"
+#include "include/forti_api/api.hpp"
+#include "response.h"
+#include "wire.h"
+
+/*
+ * Dirty tracking for CMDB objects addressed as `{endpoint}/{name}`.
+ *
+ * modify() snapshots the object's wire form; setters called afterwards only change the object, and commit() sends a
+ * single PUT holding just the attributes that differ from the snapshot.  Setters called outside modify() still write
+ * through immediately (to the root vdom), but as a one-attribute partial PUT instead of the whole object.  Objects that
+ * are only read carry nothing but an empty pointer: the snapshot is allocated when an edit starts.
+ */
+template<typename Derived>
+class Editable {
+    struct Batch {
+        nlohmann::json baseline;
+        std::string vdom;
+    };
+
+    std::unique_ptr<Batch> batch;  // null when not batching
+
+    [[nodiscard]] const Derived& self() const { return static_cast<const Derived&>(*this); }
+
+protected:
+    Editable() = default;
+    Editable(const Editable& other) : batch(other.batch ? std::make_unique<Batch>(*other.batch) : nullptr) {}
+    Editable(Editable&&) noexcept = default;
+    ~Editable() = default;
+
+    Editable& operator=(const Editable& other) {
+        if (this != &other) batch = other.batch ? std::make_unique<Batch>(*other.batch) : nullptr;
+        return *this;
+    }
+
+    Editable& operator=(Editable&&) noexcept = default;
+
+    // applies `change`, writing it through unless a modify() batch is open
+    template<typename F>
+    void edit(F change) {
+        bool batching = editing();
+        if (!batching) modify();
+        try {
+            change();
+        } catch (...) {
+            if (!batching) discard();
+            throw;
+        }
+        if (!batching) {
+            // a failed write-through must not leave a hidden batch open behind the setter
+            try {
+                commit();
+            } catch (...) {
+                discard();
+                throw;
+            }
+        }
+    }
+
+public:
+    [[nodiscard]] bool editing() const { return batch != nullptr; }
+
+    Derived& modify(const std::string& vdom = "root") {
+        batch = std::make_unique<Batch>(Batch{nlohmann::json(self()), vdom});
+        return static_cast<Derived&>(*this);
+    }
+
+    // attributes changed since modify() (empty when not batching)
+    [[nodiscard]] nlohmann::json changes() const {
+        return editing() ? Wire::diff(batch->baseline, nlohmann::json(self())) : nlohmann::json::object();
+    }
+
+    // sends the pending changes as one PUT to the object's original name; nullopt when nothing changed.  The batch
+    // stays open when the PUT throws, so commit() can simply be called again.
+    std::optional<Response> commit() {
+        if (!editing()) return std::nullopt;
+        auto patch = changes();
+        if (patch.empty()) {
+            batch.reset();
+            return std::nullopt;
+        }
+        auto name = batch->baseline.value("name", self().name);
+        auto response = FortiAPI::put(std::format("{}/{}?vdom={}", Derived::endpoint, name, batch->vdom),
+                                      Wire::Document{std::move(patch)});
+        batch.reset();
+        return response;
+    }
+
+    void discard() { batch.reset(); }
+};
+
+#endif //FORTI_API_EDITABLE_H
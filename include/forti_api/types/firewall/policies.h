@@ -11,15 +11,15 @@
 struct Module { std::string name, q_origin_key; };
 
 struct Interface : public Module {
-    NLOHMANN_DEFINE_TYPE_INTRUSIVE_WITH_DEFAULT(Interface, name, q_origin_key)
+    FORTI_API_DEFINE_TYPE_INTRUSIVE_WITH_DEFAULT(Interface, name, q_origin_key)
 };
 
 struct Address : public Module {
-    NLOHMANN_DEFINE_TYPE_INTRUSIVE_WITH_DEFAULT(Address, name, q_origin_key)
+    FORTI_API_DEFINE_TYPE_INTRUSIVE_WITH_DEFAULT(Address, name, q_origin_key)
 };
 
 struct Service : public Module {
-    NLOHMANN_DEFINE_TYPE_INTRUSIVE_WITH_DEFAULT(Service, name, q_origin_key)
+    FORTI_API_DEFINE_TYPE_INTRUSIVE_WITH_DEFAULT(Service, name, q_origin_key)
 };
 
 struct FirewallPolicy {
@@ -30,7 +30,7 @@ struct FirewallPolicy {
     std::string status, name, action, ssl_ssh_profile, av_profile, webfilter_profile, dnsfilter_profile,
             nat, inbound, outbound, natinbound, natoutbound, comments, vlan_filter;
 
-    NLOHMANN_DEFINE_TYPE_INTRUSIVE_WITH_DEFAULT(FirewallPolicy, policyid, q_origin_key, uuid_idx,
+    FORTI_API_DEFINE_TYPE_INTRUSIVE_WITH_DEFAULT(FirewallPolicy, policyid, q_origin_key, uuid_idx,
             srcintf, dstintf, srcaddr, dstaddr, service,
             status, name, action, ssl_ssh_profile,
             av_profile, webfilter_profile, dnsfilter_profile, nat,
@@ -40,7 +40,7 @@ struct FirewallPolicy {
 struct FirewallPoliciesResponse : public Response {
     std::vector<FirewallPolicy> results;
 
-    NLOHMANN_DEFINE_TYPE_INTRUSIVE_WITH_DEFAULT(FirewallPoliciesResponse, http_method, size, matched_count, next_idx,
+    FORTI_API_DEFINE_TYPE_INTRUSIVE_WITH_DEFAULT(FirewallPoliciesResponse, http_method, size, matched_count, next_idx,
             revision, vdom, path, name, status, http_status, serial, version, build, results)
 };
 
@@ -8,6 +8,7 @@
 #include "nlohmann/json.hpp"
 #include "../response.h"
 #include "../colors.h"
+#include "../editable.h"
 
 enum ScheduleDays {
     SUNDAY,
@@ -19,18 +20,19 @@ enum ScheduleDays {
     SATURDAY
 };
 
-struct FirewallSchedule {
+struct FirewallSchedule : public Editable<FirewallSchedule> {
     inline static std::string endpoint = "/cmdb/firewall.schedule/recurring";
     std::string name, q_origin_key, start, end, day, fabric_object;
     unsigned int color{};
 
     FirewallSchedule() = default;
-    explicit FirewallSchedule(std::string name, const std::string& vdom="root") : name(std::move(name)) {
-        set_all_day();
+    // creates the schedule (all day, every day) with a single POST
+    explicit FirewallSchedule(std::string name, const std::string& vdom="root")
+            : name(std::move(name)), start("00:00"), end("00:00") {
         add(vdom);
     }
 
-    NLOHMANN_DEFINE_TYPE_INTRUSIVE_WITH_DEFAULT(FirewallSchedule, name, q_origin_key, start, end, day, fabric_object, color);
+    FORTI_API_DEFINE_TYPE_INTRUSIVE_WITH_DEFAULT(FirewallSchedule, name, q_origin_key, start, end, day, fabric_object, color);
 
     void update(const std::string& vdom="root") {
         FortiAPI::put(std::format("{}/{}?vdom={}", endpoint, name, vdom), *this);
@@ -45,48 +47,45 @@ struct FirewallSchedule {
     }
 
     void set_time(const std::string& start_time, const std::string& end_time) {
-        start = start_time;
-        end = end_time;
-        update();
+        edit([&] {
+            start = start_time;
+            end = end_time;
+        });
     }
 
     void set_all_day() {
-        start = "00:00";
-        end = "00:00";
-        update();
+        set_time("00:00", "00:00");
     }
 
     void set_start_time(const std::string& start_time) {
-        start = start_time;
-        update();
+        edit([&] { start = start_time; });
     }
 
     void set_end_time(const std::string& end_time) {
-        end = end_time;
-        update();
+        edit([&] { end = end_time; });
     }
 
     void set_days(const std::vector<ScheduleDays>& days) {
-        day = "";
-        for (unsigned int i = 0; i < days.size(); ++i) {
-            day += std::to_string(days[i]);
-            if (i != days.size() - 1) day += ",";
-        }
-        std::transform(day.begin(), day.end(), day.begin(),
-                       [](unsigned char c) { return std::tolower(c); });
-        update();
+        edit([&] {
+            day = "";
+            for (unsigned int i = 0; i < days.size(); ++i) {
+                day += std::to_string(days[i]);
+                if (i != days.size() - 1) day += ",";
+            }
+            std::transform(day.begin(), day.end(), day.begin(),
+                           [](unsigned char c) { return std::tolower(c); });
+        });
     }
 
     void set_color(const Color& new_color) {
-        color = new_color;
-        update();
+        edit([&] { color = new_color; });
     }
 };
 
 struct FirewallSchedulesResponse : public Response {
     std::vector<FirewallSchedule> results;
 
-    NLOHMANN_DEFINE_TYPE_INTRUSIVE_WITH_DEFAULT(FirewallSchedulesResponse, http_method, size, matched_count, next_idx,
+    FORTI_API_DEFINE_TYPE_INTRUSIVE_WITH_DEFAULT(FirewallSchedulesResponse, http_method, size, matched_count, next_idx,
             revision, vdom, path, name, status, http_status, serial, version, build, results);
 };
 
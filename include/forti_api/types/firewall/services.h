@@ -8,6 +8,8 @@
 #include "nlohmann/json.hpp"
 #include "include/forti_api/types/response.h"
 #include "include/forti_api/api.hpp"
+#include "include/forti_api/query.hpp"
+#include "include/forti_api/types/editable.h"
 
 enum ServiceProtocol { TCP, UDP, SCTP };
 
@@ -19,7 +21,7 @@ struct ServiceCategory {
 
     ServiceCategory() = default;
 
-    NLOHMANN_DEFINE_TYPE_INTRUSIVE_WITH_DEFAULT(ServiceCategory, name, q_origin_key, comment, fabric_object);
+    FORTI_API_DEFINE_TYPE_INTRUSIVE_WITH_DEFAULT(ServiceCategory, name, q_origin_key, comment, fabric_object);
 
     void del() { FortiAPI::del(std::format("{}/{}", endpoint, name)); }
 
@@ -29,11 +31,11 @@ struct ServiceCategory {
 struct ServiceCategoriesResponse : public Response {
     std::vector<ServiceCategory> results;
 
-    NLOHMANN_DEFINE_TYPE_INTRUSIVE_WITH_DEFAULT(ServiceCategoriesResponse, http_method, size, matched_count, next_idx,
+    FORTI_API_DEFINE_TYPE_INTRUSIVE_WITH_DEFAULT(ServiceCategoriesResponse, http_method, size, matched_count, next_idx,
             revision, vdom, path, name, status, http_status, serial, version, build, results);
 };
 
-struct FirewallService {
+struct FirewallService : public Editable<FirewallService> {
     inline static std::string endpoint = "/cmdb/firewall.service/custom";
     std::string name, q_origin_key, uuid, proxy, category, protocol, helper, iprange, fqdn, tcp_portrange, udp_portrange,
             sctp_portrange, session_ttl, check_reset_range, comment, app_service_type, fabric_object;
@@ -44,7 +46,7 @@ struct FirewallService {
 
     FirewallService() = default;
 
-    NLOHMANN_DEFINE_TYPE_INTRUSIVE_WITH_DEFAULT(FirewallService, name, q_origin_key, uuid, proxy, category, protocol,
+    FORTI_API_DEFINE_TYPE_INTRUSIVE_WITH_DEFAULT(FirewallService, name, q_origin_key, uuid, proxy, category, protocol,
             helper, iprange, fqdn, tcp_portrange, udp_portrange, sctp_portrange,
             session_ttl, check_reset_range, comment, app_service_type, fabric_object,
             uuid_idx, tcp_halfclose_timer, tcp_halfopen_timer, tcp_timewait_timer,
@@ -56,34 +58,12 @@ struct FirewallService {
 
     void set_port(unsigned int port, const ServiceProtocol& proto=TCP) {
         std::string p = std::to_string(port);
-        switch (proto) {
-            case TCP:
-                tcp_portrange = p;
-                break;
-            case UDP:
-                udp_portrange = p;
-                break;
-            case SCTP:
-                sctp_portrange = p;
-                break;
-        }
-        update();
+        edit([&] { port_range_of(proto) = p; });
     }
 
     void set_port_range(std::pair<unsigned int, unsigned int> range, const ServiceProtocol& proto=TCP) {
         std::string port_range = std::format("{}-{}", range.first, range.second);
-        switch (proto) {
-            case TCP:
-                tcp_portrange = port_range;
-                break;
-            case UDP:
-                udp_portrange = port_range;
-                break;
-            case SCTP:
-                sctp_portrange = port_range;
-                break;
-        }
-        update();
+        edit([&] { port_range_of(proto) = port_range; });
     }
 
     void set_port_range(const std::vector<std::pair<unsigned int, unsigned int>>& ranges, const ServiceProtocol& proto) {
@@ -94,44 +74,35 @@ struct FirewallService {
             if (i < ranges.size() - 1) port_ranges += " ";
         }
 
-        switch (proto) {
-            case TCP:
-                tcp_portrange = port_ranges;
-                break;
-            case UDP:
-                udp_portrange = port_ranges;
-                break;
-            case SCTP:
-                sctp_portrange = port_ranges;
-                break;
-        }
-
-        update();
+        edit([&] { port_range_of(proto) = port_ranges; });
     }
 
     void set_category(const std::string& category_name) {
-        auto categories = FortiAPI::get<ServiceCategoriesResponse>(ServiceCategory::endpoint).results;
-        for (const auto& cat : categories) {
-            if (cat.name == category_name) {
-                category = category_name;
-                update();
-                return;
-            }
-        }
+        auto query = Query<ServiceCategory>().eq(&ServiceCategory::name, category_name);
+        if (FortiAPI::get<ServiceCategoriesResponse>(query.apply(ServiceCategory::endpoint)).results.empty())
+            throw std::runtime_error("Unable to locate category: " + category_name + ". Did you mean to create the category first?");
 
-        throw std::runtime_error("Unable to locate category: " + category_name + ". Did you mean to create the category first?");
+        edit([&] { category = category_name; });
     }
 
     void set_comment(const std::string& new_comment) {
-        comment = new_comment;
-        update();
+        edit([&] { comment = new_comment; });
+    }
+
+private:
+    std::string& port_range_of(ServiceProtocol proto) {
+        switch (proto) {
+            case UDP: return udp_portrange;
+            case SCTP: return sctp_portrange;
+            default: return tcp_portrange;
+        }
     }
 };
 
 struct FirewallServicesResponse : public Response {
     std::vector<FirewallService> results;
 
-    NLOHMANN_DEFINE_TYPE_INTRUSIVE_WITH_DEFAULT(FirewallServicesResponse, http_method, size, matched_count, next_idx,
+    FORTI_API_DEFINE_TYPE_INTRUSIVE_WITH_DEFAULT(FirewallServicesResponse, http_method, size, matched_count, next_idx,
             revision, vdom, path, name, status, http_status, serial, version, build, results)
 };
 
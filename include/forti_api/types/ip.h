@@ -0,0 +1,257 @@
+#ifndef FORTI_API_IP_H
+#define FORTI_API_IP_H
+
+#include <array>
+#include <compare>
+#include <bit>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <variant>
+
+/*
+ * Compact IPv4/IPv6 networks and an allocation-free parser for the spellings FortiOS uses:
+ *
+ *     "10.0.0.1", "10.0.0.0/8", "10.0.0.0 255.0.0.0"               (IPv4, address + prefix or netmask)
+ *     "2001:db8::1", "2001:db8::/32", "::ffff:192.0.2.1/128"        (IPv6, RFC 4291 text forms)
+ *
+ * A bare address is a host network (/32 or /128).  Host bits are cleared on parse so equal networks compare equal no
+ * matter how they were written; to_string() emits the form FortiOS reports ("a.b.c.d m.m.m.m" / RFC 5952).
+ */
+struct IPv4Network {
+    std::uint32_t address{};
+    std::uint8_t prefix = 32;
+
+    [[nodiscard]] static constexpr std::uint32_t mask(unsigned int prefix) {
+        return prefix == 0 ? 0 : ~std::uint32_t{0} << (32 - prefix);
+    }
+
+    [[nodiscard]] constexpr bool contains(const IPv4Network& other) const {
+        return prefix <= other.prefix && (other.address & mask(prefix)) == address;
+    }
+
+    // the enclosing network of the given (not longer) prefix
+    [[nodiscard]] constexpr IPv4Network supernet(unsigned int length) const {
+        return {address & mask(length), static_cast<std::uint8_t>(length)};
+    }
+
+    [[nodiscard]] std::string to_string() const {
+        auto dotted = [](std::uint32_t value) {
+            std::string out;
+            for (int shift = 24; shift >= 0; shift -= 8) {
+                if (!out.empty()) out += '.';
+                out += std::to_string((value >> shift) & 0xFF);
+            }
+            return out;
+        };
+        return dotted(address) + ' ' + dotted(mask(prefix));
+    }
+
+    constexpr bool operator==(const IPv4Network&) const = default;
+    constexpr auto operator<=>(const IPv4Network&) const = default;  // by address, then prefix
+};
+
+struct IPv6Network {
+    std::array<std::uint8_t, 16> address{};
+    std::uint8_t prefix = 128;
+
+    [[nodiscard]] constexpr bool contains(const IPv6Network& other) const {
+        if (prefix > other.prefix) return false;
+        unsigned int bytes = prefix / 8, bits = prefix % 8;
+        for (unsigned int i = 0; i < bytes; ++i) if (address[i] != other.address[i]) return false;
+        if (bits == 0) return true;
+        auto mask = static_cast<std::uint8_t>(0xFF << (8 - bits));
+        return (other.address[bytes] & mask) == address[bytes];
+    }
+
+    // the enclosing network of the given (not longer) prefix
+    [[nodiscard]] constexpr IPv6Network supernet(unsigned int length) const {
+        IPv6Network wider{address, static_cast<std::uint8_t>(length)};
+        for (unsigned int bit = length; bit < 128; ++bit)
+            wider.address[bit / 8] &= static_cast<std::uint8_t>(~(0x80 >> (bit % 8)));
+        return wider;
+    }
+
+    // RFC 5952: lowercase, no leading zeros, the longest run (>= 2) of zero groups compressed to "::"
+    [[nodiscard]] std::string to_string() const {
+        static constexpr char hex[] = "0123456789abcdef";
+        std::array<unsigned int, 8> groups{};
+        for (std::size_t i = 0; i < 8; ++i) groups[i] = address[2 * i] << 8 | address[2 * i + 1];
+
+        std::size_t run_start = 8, run_length = 0;
+        for (std::size_t i = 0; i < 8;) {
+            std::size_t j = i;
+            while (j < 8 && groups[j] == 0) ++j;
+            if (j - i > run_length && j - i >= 2) run_start = i, run_length = j - i;
+            i = j == i ? i + 1 : j;
+        }
+
+        std::string out;
+        for (std::size_t i = 0; i < 8; ++i) {
+            if (i == run_start) {
+                out += "::";
+                i += run_length - 1;
+                continue;
+            }
+            if (!out.empty() && out.back() != ':') out += ':';
+            bool leading = true;
+            for (int shift = 12; shift >= 0; shift -= 4) {
+                auto digit = (groups[i] >> shift) & 0xF;
+                if (leading && digit == 0 && shift != 0) continue;
+                leading = false;
+                out += hex[digit];
+            }
+        }
+        return out + '/' + std::to_string(prefix);
+    }
+
+    constexpr bool operator==(const IPv6Network&) const = default;
+    constexpr auto operator<=>(const IPv6Network&) const = default;  // by address, then prefix
+};
+
+using IPNetwork = std::variant<IPv4Network, IPv6Network>;
+
+namespace IP {
+
+    namespace detail {
+        // decimal in [0, max] without leading zeros
+        constexpr std::optional<unsigned int> decimal(std::string_view text, unsigned int max) {
+            if (text.empty() || text.size() > 3 || (text.size() > 1 && text[0] == '0')) return std::nullopt;
+            unsigned int value = 0;
+            for (char c : text) {
+                if (c < '0' || c > '9') return std::nullopt;
+                value = value * 10 + static_cast<unsigned int>(c - '0');
+            }
+            if (value > max) return std::nullopt;
+            return value;
+        }
+
+        constexpr std::optional<std::uint32_t> dotted_quad(std::string_view text) {
+            std::uint32_t address = 0;
+            for (int octet = 0; octet < 4; ++octet) {
+                auto end = octet == 3 ? text.size() : text.find('.');
+                if (end == std::string_view::npos) return std::nullopt;
+                auto value = decimal(text.substr(0, end), 255);
+                if (!value) return std::nullopt;
+                address = address << 8 | *value;
+                text.remove_prefix(octet == 3 ? end : end + 1);
+            }
+            return address;
+        }
+
+        constexpr int hex_digit(char c) {
+            if (c >= '0' && c <= '9') return c - '0';
+            if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+            if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+            return -1;
+        }
+    }  // namespace detail
+
+    constexpr std::optional<IPv4Network> parse_v4(std::string_view text) {
+        auto separator = text.find_first_of("/ ");
+        auto address = detail::dotted_quad(text.substr(0, separator));
+        if (!address) return std::nullopt;
+
+        unsigned int prefix = 32;
+        if (separator != std::string_view::npos) {
+            auto rest = text.substr(separator + 1);
+            if (text[separator] == '/') {
+                auto length = detail::decimal(rest, 32);
+                if (!length) return std::nullopt;
+                prefix = *length;
+            } else {
+                auto netmask = detail::dotted_quad(rest);
+                if (!netmask) return std::nullopt;
+                prefix = static_cast<unsigned int>(std::popcount(*netmask));
+                if (*netmask != IPv4Network::mask(prefix)) return std::nullopt;  // not contiguous
+            }
+        }
+        return IPv4Network{*address & IPv4Network::mask(prefix), static_cast<std::uint8_t>(prefix)};
+    }
+
+    constexpr std::optional<IPv6Network> parse_v6(std::string_view text) {
+        unsigned int prefix = 128;
+        if (auto slash = text.find('/'); slash != std::string_view::npos) {
+            auto length = detail::decimal(text.substr(slash + 1), 128);
+            if (!length) return std::nullopt;
+            prefix = *length;
+            text = text.substr(0, slash);
+        }
+
+        std::array<std::uint16_t, 8> groups{};
+        std::size_t count = 0, i = 0;
+        int gap = -1;
+        if (text.starts_with("::")) {
+            gap = 0;
+            i = 2;
+        } else if (text.starts_with(':')) return std::nullopt;
+
+        while (i < text.size()) {
+            auto end = text.find(':', i);
+            if (end == std::string_view::npos) end = text.size();
+            auto token = text.substr(i, end - i);
+
+            if (token.find('.') != std::string_view::npos) {  // embedded IPv4 in the last 32 bits
+                auto tail = detail::dotted_quad(token);
+                if (!tail || end != text.size() || count > 6) return std::nullopt;
+                groups[count++] = static_cast<std::uint16_t>(*tail >> 16);
+                groups[count++] = static_cast<std::uint16_t>(*tail & 0xFFFF);
+                i = end;
+                break;
+            }
+
+            if (token.empty() || token.size() > 4 || count == 8) return std::nullopt;
+            unsigned int value = 0;
+            for (char c : token) {
+                auto digit = detail::hex_digit(c);
+                if (digit < 0) return std::nullopt;
+                value = value << 4 | static_cast<unsigned int>(digit);
+            }
+            groups[count++] = static_cast<std::uint16_t>(value);
+
+            i = end;
+            if (i == text.size()) break;
+            if (++i == text.size()) return std::nullopt;  // trailing single ':'
+            if (text[i] == ':') {
+                if (gap >= 0) return std::nullopt;  // only one "::"
+                gap = static_cast<int>(count);
+                ++i;
+            }
+        }
+
+        if (gap < 0 ? count != 8 : count > 7) return std::nullopt;
+
+        IPv6Network network;
+        network.prefix = static_cast<std::uint8_t>(prefix);
+        std::size_t tail = gap < 0 ? 0 : count - static_cast<std::size_t>(gap);
+        for (std::size_t g = 0; g < count; ++g) {
+            auto slot = gap >= 0 && g >= static_cast<std::size_t>(gap) ? 8 - tail + (g - static_cast<std::size_t>(gap)) : g;
+            network.address[2 * slot] = static_cast<std::uint8_t>(groups[g] >> 8);
+            network.address[2 * slot + 1] = static_cast<std::uint8_t>(groups[g] & 0xFF);
+        }
+
+        return network.supernet(prefix);  // clears the host bits
+    }
+
+    constexpr std::optional<IPNetwork> parse(std::string_view text) {
+        if (text.find(':') != std::string_view::npos) {
+            if (auto v6 = parse_v6(text)) return IPNetwork(*v6);
+        } else if (auto v4 = parse_v4(text)) return IPNetwork(*v4);
+        return std::nullopt;
+    }
+
+    // true when `outer` covers every address of `inner` (never across families)
+    constexpr bool contains(const IPNetwork& outer, const IPNetwork& inner) {
+        if (outer.index() != inner.index()) return false;
+        if (auto v4 = std::get_if<IPv4Network>(&outer)) return v4->contains(std::get<IPv4Network>(inner));
+        return std::get<IPv6Network>(outer).contains(std::get<IPv6Network>(inner));
+    }
+
+    inline std::string to_string(const IPNetwork& network) {
+        return std::visit([](const auto& n) { return n.to_string(); }, network);
+    }
+
+}  // namespace IP
+
+#endif //FORTI_API_IP_H
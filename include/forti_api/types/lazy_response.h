@@ -0,0 +1,52 @@
+#ifndef FORTI_API_LAZY_RESPONSE_H
+#define FORTI_API_LAZY_RESPONSE_H
+
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+#include "nlohmann/json.hpp"
+#include "include/forti_api/stream.hpp"
+#include "response.h"
+
+/*
+ * Response whose envelope is decoded up front while `results` stays raw JSON until results() is called.  The body is
+ * scanned once with JsonArrayStream (no DOM is built for the array), so existence checks and anything else that only
+ * reads http_status, matched_count or revision never pay for decoding the objects.  Copies share the raw body.
+ */
+template<typename T>
+class LazyResponse : public Response {
+    std::shared_ptr<const std::string> body;
+    std::size_t begin{}, end{};
+
+public:
+    // nullopt when the envelope is not JSON
+    static std::optional<LazyResponse> from_body(std::string raw) {
+        auto split = JsonArrayStream::split(raw);
+        auto envelope = nlohmann::json::parse(split.envelope, nullptr, false);
+        if (envelope.is_discarded()) return std::nullopt;
+
+        LazyResponse response;
+        static_cast<Response&>(response) = envelope.get<Response>();
+        if (split.end != std::string::npos) {
+            response.begin = split.begin;
+            response.end = split.end;
+            response.body = std::make_shared<const std::string>(std::move(raw));
+        }
+        return response;
+    }
+
+    // the results array as received
+    [[nodiscard]] std::string_view raw_results() const {
+        return body ? std::string_view(*body).substr(begin, end - begin) : std::string_view("[]");
+    }
+
+    // decodes the results; every call parses the raw bytes again
+    [[nodiscard]] std::vector<T> results() const {
+        return nlohmann::json::parse(raw_results()).template get<std::vector<T>>();
+    }
+};
+
+#endif //FORTI_API_LAZY_RESPONSE_H
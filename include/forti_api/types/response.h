@@ -6,12 +6,13 @@
 #define FORTI_API_RESPONSE_H
 
 #include "nlohmann/json.hpp"
+#include "wire.h"
 
 struct Response {
     unsigned int size{}, matched_count{}, next_idx{}, http_status{}, build{};
     std::string http_method, revision, vdom, path, name, status, serial, version;
 
-    NLOHMANN_DEFINE_TYPE_INTRUSIVE_WITH_DEFAULT(Response, http_method, size, matched_count, next_idx, revision,
+    FORTI_API_DEFINE_TYPE_INTRUSIVE_WITH_DEFAULT(Response, http_method, size, matched_count, next_idx, revision,
             vdom, path, name, status, http_status, serial, version, build)
 };
 
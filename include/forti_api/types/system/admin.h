@@ -5,14 +5,21 @@
 #ifndef FORTI_API_ADMIN_H
 #define FORTI_API_ADMIN_H
 
+#include <algorithm>
+#include <array>
+#include <optional>
+#include <type_traits>
+#include <variant>
+#include <vector>
 #include "nlohmann/json.hpp"
 #include "../response.h"
 #include "../../api.hpp"
+#include "../ip.h"
 
 struct VDomEntry {
     std::string name, q_origin_key;
 
-    NLOHMANN_DEFINE_TYPE_INTRUSIVE_WITH_DEFAULT(VDomEntry, name, q_origin_key)
+    FORTI_API_DEFINE_TYPE_INTRUSIVE_WITH_DEFAULT(VDomEntry, name, q_origin_key)
 };
 
 enum class TrustHostType {
@@ -20,68 +27,139 @@ enum class TrustHostType {
     IPV6,
 };
 
+// one row of an API user's trusthost table; the subnet is kept parsed so lookups never touch strings
 struct TrustHostEntry {
-    unsigned int id{}, q_origin_key{};
-    std::string type;
+    unsigned int id{};
+    IPNetwork subnet;
 
-    TrustHostEntry() = default;
-    explicit TrustHostEntry(std::string type) : type(std::move(type)) {}
-
-    [[nodiscard]] virtual TrustHostType get_type() const = 0;
-    [[nodiscard]] virtual std::string get_subnet() const = 0;
-    virtual ~TrustHostEntry() = default;
+    [[nodiscard]] TrustHostType get_type() const {
+        return std::holds_alternative<IPv4Network>(subnet) ? TrustHostType::IPV4 : TrustHostType::IPV6;
+    }
+    [[nodiscard]] std::string get_subnet() const { return IP::to_string(subnet); }
 
     [[nodiscard]] bool is_ipv4() const { return get_type() == TrustHostType::IPV4; }
     [[nodiscard]] bool is_ipv6() const { return get_type() == TrustHostType::IPV6; }
 
     friend void to_json(nlohmann::json& j, const TrustHostEntry& host) {
-        j = nlohmann::json{
-                {"id", host.id},
-                {"q_origin_key", host.q_origin_key},
-                {"type", host.type},
-                {host.is_ipv4() ? "ipv4-trusthost" : "ipv6-trusthost", host.get_subnet()}
-        };
+        auto type = host.is_ipv4() ? "ipv4-trusthost" : "ipv6-trusthost";
+        j = nlohmann::json{{"id", host.id}, {"type", type}, {type, host.get_subnet()}};
     }
-};
 
-// Derived class for IPv4 TrustHost
-struct IPV4TrustHost : public TrustHostEntry {
-    std::string ipv4_trusthost;
+    friend void from_json(const nlohmann::json& j, TrustHostEntry& host) {
+        auto type = j.value("type", std::string("ipv4-trusthost"));
+        auto text = j.value(type, std::string());
+        auto subnet = type == "ipv6-trusthost" ? IP::parse_v6(text).transform([](auto n) { return IPNetwork(n); })
+                                               : IP::parse_v4(text).transform([](auto n) { return IPNetwork(n); });
+        if (!subnet) throw std::runtime_error(std::format("Invalid {}: {}", type, text));
+        host.id = j.value("id", 0u);
+        host.subnet = *subnet;
+    }
+};
 
-    [[nodiscard]] TrustHostType get_type() const override { return TrustHostType::IPV4; }
-    [[nodiscard]] std::string get_subnet() const override { return ipv4_trusthost; }
+/*
+ * An API user's trusthost table.  The entries stay in wire order; alongside them each family keeps its networks
+ * sorted by (address, prefix) with a count per prefix length, so finding a covering entry is one binary search per
+ * prefix length in use instead of a scan over the whole allowlist.
+ */
+class TrustHost {
+    template<typename Network, std::size_t Bits>
+    struct Index {
+        std::vector<Network> sorted;
+        std::array<unsigned int, Bits + 1> per_prefix{};
+
+        void insert(const Network& network) {
+            sorted.insert(std::upper_bound(sorted.begin(), sorted.end(), network), network);
+            ++per_prefix[network.prefix];
+        }
+
+        void erase(const Network& network) {
+            auto [first, last] = std::equal_range(sorted.begin(), sorted.end(), network);
+            per_prefix[network.prefix] -= static_cast<unsigned int>(last - first);
+            sorted.erase(first, last);
+        }
+
+        [[nodiscard]] std::optional<Network> covering(const Network& network) const {
+            for (unsigned int length = 0; length <= network.prefix; ++length) {
+                if (per_prefix[length] == 0) continue;
+                auto wider = network.supernet(length);
+                if (std::binary_search(sorted.begin(), sorted.end(), wider)) return wider;
+            }
+            return std::nullopt;
+        }
+    };
+
+    std::vector<TrustHostEntry> entries;  // wire order
+    Index<IPv4Network, 32> v4;
+    Index<IPv6Network, 128> v6;
+    unsigned int max_id = 0;
+
+    void index(const IPNetwork& subnet) {
+        std::visit([this](const auto& network) {
+            if constexpr (std::is_same_v<std::decay_t<decltype(network)>, IPv4Network>) v4.insert(network);
+            else v6.insert(network);
+        }, subnet);
+    }
 
-    IPV4TrustHost() = default;
-    explicit IPV4TrustHost(std::string ip_addr) : TrustHostEntry("ipv4-trusthost"), ipv4_trusthost(std::move(ip_addr)) {}
+    [[nodiscard]] std::optional<IPNetwork> covering_network(const IPNetwork& network) const {
+        return std::visit([this](const auto& query) -> std::optional<IPNetwork> {
+            if constexpr (std::is_same_v<std::decay_t<decltype(query)>, IPv4Network>) return v4.covering(query);
+            else return v6.covering(query);
+        }, network);
+    }
 
-    NLOHMANN_DEFINE_TYPE_INTRUSIVE_WITH_DEFAULT(IPV4TrustHost, id, q_origin_key, type, ipv4_trusthost)
-};
+public:
+    using const_iterator = std::vector<TrustHostEntry>::const_iterator;
+
+    [[nodiscard]] const_iterator begin() const { return entries.begin(); }
+    [[nodiscard]] const_iterator end() const { return entries.end(); }
+    [[nodiscard]] std::size_t size() const { return entries.size(); }
+    [[nodiscard]] bool empty() const { return entries.empty(); }
+    [[nodiscard]] const TrustHostEntry& front() const { return entries.front(); }
+    [[nodiscard]] const TrustHostEntry& back() const { return entries.back(); }
+    [[nodiscard]] const TrustHostEntry& operator[](std::size_t i) const { return entries[i]; }
+
+    // true when some entry's subnet covers `network`
+    [[nodiscard]] bool covers(const IPNetwork& network) const { return covering_network(network).has_value(); }
+
+    // the entry whose subnet covers `network`, if any
+    [[nodiscard]] const TrustHostEntry* covering(const IPNetwork& network) const {
+        auto subnet = covering_network(network);
+        if (!subnet) return nullptr;
+        auto it = std::find_if(entries.begin(), entries.end(),
+                               [&subnet](const TrustHostEntry& entry) { return entry.subnet == *subnet; });
+        return it == entries.end() ? nullptr : &*it;
+    }
 
-// Derived class for IPv6 TrustHost
-struct IPV6TrustHost : public TrustHostEntry {
-    std::string ipv6_trusthost;
+    // one past the highest id handed out so far, so a removed entry's id is never reused
+    [[nodiscard]] unsigned int next_id() const { return max_id + 1; }
 
-    [[nodiscard]] TrustHostType get_type() const override { return TrustHostType::IPV6; }
-    [[nodiscard]] std::string get_subnet() const override { return ipv6_trusthost; }
+    void push_back(TrustHostEntry entry) {
+        index(entry.subnet);
+        max_id = std::max(max_id, entry.id);
+        entries.push_back(std::move(entry));
+    }
 
-    IPV6TrustHost() = default;
-    explicit IPV6TrustHost(std::string ip_addr) : TrustHostEntry("ipv4-trusthost"), ipv6_trusthost(std::move(ip_addr)) {}
+    // removes every entry for exactly this subnet
+    void erase(const IPNetwork& network) {
+        std::visit([this](const auto& subnet) {
+            if constexpr (std::is_same_v<std::decay_t<decltype(subnet)>, IPv4Network>) v4.erase(subnet);
+            else v6.erase(subnet);
+        }, network);
+        std::erase_if(entries, [&network](const TrustHostEntry& entry) { return entry.subnet == network; });
+    }
 
-    NLOHMANN_DEFINE_TYPE_INTRUSIVE_WITH_DEFAULT(IPV6TrustHost, id, q_origin_key, type, ipv6_trusthost)
-};
+    void clear() { *this = TrustHost(); }
 
-struct TrustHost : public std::vector<std::shared_ptr<TrustHostEntry>> {
-friend void from_json(const nlohmann::json& j, TrustHost& th) {
-    for (const auto& item : j) {
-        auto type = item.at("type").get<std::string>();
-        if (type == "ipv4-trusthost") th.push_back(std::make_shared<IPV4TrustHost>(item));
-        else th.push_back(std::make_shared<IPV6TrustHost>(item));
+    friend void from_json(const nlohmann::json& j, TrustHost& th) {
+        th.clear();
+        th.entries.reserve(j.size());
+        for (const auto& item : j) th.push_back(item.get<TrustHostEntry>());
     }
-}
 
-friend void to_json(nlohmann::json& j, const TrustHost& th) {
-    for (const auto& host : th) j.push_back(*host);
-}
+    friend void to_json(nlohmann::json& j, const TrustHost& th) {
+        j = nlohmann::json::array();
+        for (const auto& host : th) j.push_back(host);
+    }
 };
 
 struct APIUser {
@@ -90,39 +168,43 @@ struct APIUser {
             peer_auth, peer_group;
     TrustHost trusthost;
 
-    NLOHMANN_DEFINE_TYPE_INTRUSIVE_WITH_DEFAULT(APIUser, name, q_origin_key, comments, api_key, accprofile,
+    FORTI_API_DEFINE_TYPE_INTRUSIVE_WITH_DEFAULT(APIUser, name, q_origin_key, comments, api_key, accprofile,
             schedule, cors_allow_origin, peer_auth, peer_group, trusthost)
 
-    bool is_trusted(const std::string& subnet) {
-        return std::any_of(trusthost.begin(), trusthost.end(),
-                           [&subnet](const std::shared_ptr<TrustHostEntry>& host) {
-                               return host->get_subnet() == subnet;
-                           });
+    // true when some trusthost covers the whole subnet ("10.1.2.3" is trusted by "10.0.0.0/8")
+    [[nodiscard]] bool is_trusted(std::string_view subnet) const {
+        auto network = IP::parse(subnet);
+        return network && trusthost.covers(*network);
     }
 
-    void trust(const std::string& subnet) {
-        if (is_trusted(subnet)) return;
-        if (std::regex_match(subnet, ipv4)) trusthost.push_back(std::make_shared<IPV4TrustHost>(subnet));
-        else if (std::regex_match(subnet, ipv6)) trusthost.push_back(std::make_shared<IPV6TrustHost>(subnet));
+    // adds the subnet unless an existing trusthost already covers it
+    void trust(std::string_view subnet) {
+        auto network = parse_subnet(subnet);
+        if (!trusthost.covers(network)) trusthost.push_back({trusthost.next_id(), network});
     }
 
-    void distrust(const std::string& subnet) {
-        if (!is_trusted(subnet)) return;
-        trusthost.erase(std::remove_if(trusthost.begin(), trusthost.end(),
-                                       [&subnet](const std::shared_ptr<TrustHostEntry>& entry) {
-                                           return entry->get_subnet() == subnet;
-                                       }), trusthost.end());
+    // removes the trusthost for exactly this subnet (narrower entries and wider covering ones are kept)
+    void distrust(std::string_view subnet) {
+        auto network = parse_subnet(subnet);
+        trusthost.erase(network);
     }
 
     void update() {
         FortiAPI::put(std::format("{}/{}", api_user_endpoint, name), *this);
     }
+
+private:
+    static IPNetwork parse_subnet(std::string_view subnet) {
+        auto network = IP::parse(subnet);
+        if (!network) throw std::invalid_argument(std::format("Not an IPv4/IPv6 address or subnet: {}", subnet));
+        return *network;
+    }
 };
 
 struct AllAPIUsersResponse : public Response {
     std::vector<APIUser> results;
 
-    NLOHMANN_DEFINE_TYPE_INTRUSIVE_WITH_DEFAULT(AllAPIUsersResponse, http_method, size, matched_count, next_idx,
+    FORTI_API_DEFINE_TYPE_INTRUSIVE_WITH_DEFAULT(AllAPIUsersResponse, http_method, size, matched_count, next_idx,
             revision, vdom, path, name, status, http_status, serial, version,
             build, results)
 };
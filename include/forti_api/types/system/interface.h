@@ -12,20 +12,20 @@ struct SystemResponse {
     unsigned int build{};
     std::string http_method, revision, vdom, path, name, action, status, serial, version;
 
-    NLOHMANN_DEFINE_TYPE_INTRUSIVE_WITH_DEFAULT(SystemResponse, build, http_method, revision, vdom, path, name, action,
+    FORTI_API_DEFINE_TYPE_INTRUSIVE_WITH_DEFAULT(SystemResponse, build, http_method, revision, vdom, path, name, action,
             status, serial, version);
 };
 
 struct GeneralInterface {
     std::string name;
 
-    NLOHMANN_DEFINE_TYPE_INTRUSIVE_WITH_DEFAULT(GeneralInterface, name);
+    FORTI_API_DEFINE_TYPE_INTRUSIVE_WITH_DEFAULT(GeneralInterface, name);
 };
 
 struct GeneralResponse : public Response {
     std::vector<GeneralInterface> results;
 
-    NLOHMANN_DEFINE_TYPE_INTRUSIVE_WITH_DEFAULT(GeneralResponse, http_method, size, matched_count, next_idx,
+    FORTI_API_DEFINE_TYPE_INTRUSIVE_WITH_DEFAULT(GeneralResponse, http_method, size, matched_count, next_idx,
             revision, vdom, path, name, status, http_status, serial, version,
             build, results)
 };
@@ -34,7 +34,7 @@ struct IPV4Address {
     std::string ip, netmask;
     unsigned int cidr_netmask{};
 
-    NLOHMANN_DEFINE_TYPE_INTRUSIVE_WITH_DEFAULT(IPV4Address, ip, netmask, cidr_netmask);
+    FORTI_API_DEFINE_TYPE_INTRUSIVE_WITH_DEFAULT(IPV4Address, ip, netmask, cidr_netmask);
 };
 
 struct SystemInterface {
@@ -48,7 +48,7 @@ struct SystemInterface {
     std::vector<IPV4Address> ipv4_addresses{};
     std::vector<std::string> members{};
 
-    NLOHMANN_DEFINE_TYPE_INTRUSIVE_WITH_DEFAULT(SystemInterface,
+    FORTI_API_DEFINE_TYPE_INTRUSIVE_WITH_DEFAULT(SystemInterface,
             name, type, real_interface_name, vdom, status, alias, vlan_protocol, role,
             mac_address, port_speed, media, physical_switch, link, duplex, icon,
             is_used, is_physical, dynamic_addressing, dhcp_interface, valid_in_policy,
@@ -65,14 +65,21 @@ struct VirtualWANLink {
     bool is_sdwan_zone{}, valid_in_policy{};
     std::vector<std::string> members{};
 
-    NLOHMANN_DEFINE_TYPE_INTRUSIVE_WITH_DEFAULT(VirtualWANLink, name, vdom, status, type, link, icon, is_sdwan_zone,
+    FORTI_API_DEFINE_TYPE_INTRUSIVE_WITH_DEFAULT(VirtualWANLink, name, vdom, status, type, link, icon, is_sdwan_zone,
             valid_in_policy, members);
 };
 
 struct InterfacesGeneralResponse : public SystemResponse {
     std::vector<nlohmann::json> results;
 
-    NLOHMANN_DEFINE_TYPE_INTRUSIVE_WITH_DEFAULT(InterfacesGeneralResponse, build, http_method, revision, vdom, path,
+    FORTI_API_DEFINE_TYPE_INTRUSIVE_WITH_DEFAULT(InterfacesGeneralResponse, build, http_method, revision, vdom, path,
+            name, action, status, serial, version, results);
+};
+
+struct SystemInterfacesResponse : public SystemResponse {
+    std::vector<SystemInterface> results;
+
+    FORTI_API_DEFINE_TYPE_INTRUSIVE_WITH_DEFAULT(SystemInterfacesResponse, build, http_method, revision, vdom, path,
             name, action, status, serial, version, results);
 };
 
@@ -20,7 +20,7 @@ struct PushThreatFeed {
     PushThreatFeed() = default;
     PushThreatFeed(std::string  name, unsigned int category) : name(std::move(name)), category(category) {}
 
-    NLOHMANN_DEFINE_TYPE_INTRUSIVE_WITH_DEFAULT(PushThreatFeed, name, status, type, update_method,
+    FORTI_API_DEFINE_TYPE_INTRUSIVE_WITH_DEFAULT(PushThreatFeed, name, status, type, update_method,
             server_identity_check, category, comments)
 };
 
@@ -28,14 +28,14 @@ struct FeedThreatFeed : public PushThreatFeed {
     std::string resource;
     unsigned int refresh_rate{};
 
-    NLOHMANN_DEFINE_TYPE_INTRUSIVE_WITH_DEFAULT(FeedThreatFeed, name, status, type, update_method,
+    FORTI_API_DEFINE_TYPE_INTRUSIVE_WITH_DEFAULT(FeedThreatFeed, name, status, type, update_method,
             server_identity_check, category, comments, resource, refresh_rate)
 };
 
 struct ExternalResourcesResponse : public Response {
     std::vector<PushThreatFeed> results;
 
-    NLOHMANN_DEFINE_TYPE_INTRUSIVE_WITH_DEFAULT(ExternalResourcesResponse, http_method, size, matched_count, next_idx,
+    FORTI_API_DEFINE_TYPE_INTRUSIVE_WITH_DEFAULT(ExternalResourcesResponse, http_method, size, matched_count, next_idx,
             revision, vdom, path, name, status, http_status, serial, version,
             build, results)
 };
@@ -43,7 +43,7 @@ struct ExternalResourcesResponse : public Response {
 struct Entry {
     std::string entry, valid;
 
-    NLOHMANN_DEFINE_TYPE_INTRUSIVE_WITH_DEFAULT(Entry, entry, valid);
+    FORTI_API_DEFINE_TYPE_INTRUSIVE_WITH_DEFAULT(Entry, entry, valid);
 };
 
 struct ExternalResourceEntryList {
@@ -51,14 +51,14 @@ struct ExternalResourceEntryList {
     unsigned long last_content_update_time{};
     std::vector<Entry> entries;
 
-    NLOHMANN_DEFINE_TYPE_INTRUSIVE_WITH_DEFAULT(ExternalResourceEntryList, status, resource_file_status,
+    FORTI_API_DEFINE_TYPE_INTRUSIVE_WITH_DEFAULT(ExternalResourceEntryList, status, resource_file_status,
             last_content_update_time, entries);
 };
 
 struct ExternalResourceEntryListResponse : public Response {
     ExternalResourceEntryList results;
 
-    NLOHMANN_DEFINE_TYPE_INTRUSIVE_WITH_DEFAULT(ExternalResourceEntryListResponse, http_method, size, matched_count, next_idx,
+    FORTI_API_DEFINE_TYPE_INTRUSIVE_WITH_DEFAULT(ExternalResourceEntryListResponse, http_method, size, matched_count, next_idx,
             revision, vdom, path, name, status, http_status, serial, version,
             build, results)
 };
@@ -69,8 +69,10 @@ struct CommandEntry {
 
     CommandEntry() = default;
     CommandEntry(std::string name, const std::vector<std::string>& entries) : name(std::move(name)), entries(entries) {}
+    CommandEntry(std::string name, std::vector<std::string> entries, std::string command) :
+            name(std::move(name)), command(std::move(command)), entries(std::move(entries)) {}
 
-    NLOHMANN_DEFINE_TYPE_INTRUSIVE_WITH_DEFAULT(CommandEntry, name, entries, command)
+    FORTI_API_DEFINE_TYPE_INTRUSIVE_WITH_DEFAULT(CommandEntry, name, entries, command)
 };
 
 struct CommandsRequest {
@@ -79,7 +81,7 @@ struct CommandsRequest {
     CommandsRequest() = default;
     CommandsRequest(const CommandEntry& initialEntry) : commands() { commands.push_back(initialEntry); }
 
-    NLOHMANN_DEFINE_TYPE_INTRUSIVE_WITH_DEFAULT(CommandsRequest, commands)
+    FORTI_API_DEFINE_TYPE_INTRUSIVE_WITH_DEFAULT(CommandsRequest, commands)
 };
 
 #endif //FORTI_API_EXT_CONNECTOR_H
@@ -0,0 +1,132 @@
+#ifndef FORTI_API_WIRE_H
+#define FORTI_API_WIRE_H
+
+#include <algorithm>
+#include <cstddef>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include "nlohmann/json.hpp"
+
+/*
+ * FortiOS spells CMDB attributes with hyphens ("ssl-ssh-profile") while C++ members use underscores.  Instead of
+ * rewriting every key of every document, each member's wire key is computed at compile time from its name and the
+ * generated to_json/from_json read and write the wire document directly.
+ *
+ * Envelope and most monitor payloads use underscores ("http_status", "ipv4_addresses"), so decoding falls back to
+ * the verbatim member name when the hyphenated key is absent.  q_origin_key is reported verbatim and never sent.
+ * Raw JSON bodies passed to FortiAPI::post/put go through hyphenate() instead, so callers may keep using underscore
+ * spellings; bodies derived from typed objects are wrapped in a Document to skip that pass.
+ */
+namespace Wire {
+
+    template<std::size_t N>
+    struct Key {
+        char hyphenated[N]{}, verbatim[N]{};
+
+        constexpr Key(const char (&member)[N]) {
+            bool keep = std::string_view(member, N - 1) == "q_origin_key";
+            for (std::size_t i = 0; i < N; ++i) {
+                verbatim[i] = member[i];
+                hyphenated[i] = member[i] == '_' && !keep ? '-' : member[i];
+            }
+        }
+
+        [[nodiscard]] constexpr std::string_view wire() const { return {hyphenated, N - 1}; }
+        [[nodiscard]] constexpr std::string_view member() const { return {verbatim, N - 1}; }
+        [[nodiscard]] constexpr bool has_alias() const { return wire() != member(); }
+        [[nodiscard]] constexpr bool read_only() const { return member() == "q_origin_key"; }
+    };
+
+    template<Key K>
+    constexpr std::string_view key() { return K.wire(); }
+
+    template<Key K>
+    constexpr std::string_view name() { return K.member(); }
+
+    template<Key K>
+    void write(nlohmann::json& j, const auto& value) {
+        if constexpr (!K.read_only()) j[K.wire()] = value;
+    }
+
+    template<Key K, typename T>
+    void read(const nlohmann::json& j, T& value, const T& fallback) {
+        auto it = j.find(K.wire());
+        if constexpr (K.has_alias()) if (it == j.end()) it = j.find(K.member());
+
+        if (it != j.end()) it->get_to(value);
+        else value = fallback;
+    }
+
+    // a body already in FortiOS spelling (e.g. a diff() patch of typed objects), sent by FortiAPI without another pass
+    struct Document {
+        nlohmann::json json;
+    };
+
+    // a hand-built payload in FortiOS spelling: keys at every depth hyphenated, q_origin_key dropped.  Typed objects
+    // are already written with wire keys; this is only for raw nlohmann::json bodies accepted from callers.
+    inline nlohmann::json hyphenate(const nlohmann::json& j) {
+        if (j.is_array()) {
+            nlohmann::json converted = nlohmann::json::array();
+            for (const auto& element : j) converted.push_back(hyphenate(element));
+            return converted;
+        }
+        if (!j.is_object()) return j;
+
+        nlohmann::json converted = nlohmann::json::object();
+        for (const auto& [key, value] : j.items()) {
+            if (key == "q_origin_key") continue;
+            std::string wire = key;
+            std::replace(wire.begin(), wire.end(), '_', '-');
+            converted[wire] = hyphenate(value);
+        }
+        return converted;
+    }
+
+    // top-level attributes of `after` that differ from `before`: the body of a partial PUT (FortiOS replaces
+    // table attributes wholesale, so nested values are compared and sent as a whole)
+    inline nlohmann::json diff(const nlohmann::json& before, const nlohmann::json& after) {
+        nlohmann::json changed = nlohmann::json::object();
+        for (const auto& [key, value] : after.items()) {
+            if (key == "q_origin_key") continue;
+            auto it = before.find(key);
+            if (it == before.end() || *it != value) changed[key] = value;
+        }
+        return changed;
+    }
+
+}  // namespace Wire
+
+#define FORTI_API_WIRE_KEY_OF(v1) \
+    if constexpr (std::is_same_v<decltype(member), decltype(&forti_api_self::v1)>) \
+        if (member == &forti_api_self::v1) return Wire::key<#v1>();
+#define FORTI_API_MEMBER_NAME_OF(v1) \
+    if constexpr (std::is_same_v<decltype(member), decltype(&forti_api_self::v1)>) \
+        if (member == &forti_api_self::v1) return Wire::name<#v1>();
+#define FORTI_API_WIRE_TO(v1) Wire::write<#v1>(nlohmann_json_j, nlohmann_json_t.v1);
+#define FORTI_API_WIRE_FROM_WITH_DEFAULT(v1) Wire::read<#v1>(nlohmann_json_j, nlohmann_json_t.v1, nlohmann_json_default_obj.v1);
+
+/*
+ * Drop-in replacement for NLOHMANN_DEFINE_TYPE_INTRUSIVE_WITH_DEFAULT that speaks FortiOS wire keys.  It also adds
+ * Type::wire_key(&Type::member), which resolves a mapped member to its wire key (used by queries and projections),
+ * and Type::member_name(&Type::member), its verbatim underscore spelling (used by monitor projections).
+ */
+#define FORTI_API_DEFINE_TYPE_INTRUSIVE_WITH_DEFAULT(Type, ...)  \
+    template<typename M, typename C> \
+    static constexpr std::string_view wire_key(M C::* member) { \
+        using forti_api_self = Type; \
+        NLOHMANN_JSON_EXPAND(NLOHMANN_JSON_PASTE(FORTI_API_WIRE_KEY_OF, __VA_ARGS__)) \
+        return {}; } \
+    template<typename M, typename C> \
+    static constexpr std::string_view member_name(M C::* member) { \
+        using forti_api_self = Type; \
+        NLOHMANN_JSON_EXPAND(NLOHMANN_JSON_PASTE(FORTI_API_MEMBER_NAME_OF, __VA_ARGS__)) \
+        return {}; } \
+    friend void to_json(nlohmann::json& nlohmann_json_j, const Type& nlohmann_json_t) { \
+        nlohmann_json_j = nlohmann::json::object(); \
+        NLOHMANN_JSON_EXPAND(NLOHMANN_JSON_PASTE(FORTI_API_WIRE_TO, __VA_ARGS__)) } \
+    friend void from_json(const nlohmann::json& nlohmann_json_j, Type& nlohmann_json_t) { \
+        const Type nlohmann_json_default_obj{}; \
+        NLOHMANN_JSON_EXPAND(NLOHMANN_JSON_PASTE(FORTI_API_WIRE_FROM_WITH_DEFAULT, __VA_ARGS__)) }
+
+#endif //FORTI_API_WIRE_H
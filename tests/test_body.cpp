@@ -0,0 +1,51 @@
+#include <gtest/gtest.h>
+#include "include/forti_api/body.hpp"
+#include "include/forti_api/compression.hpp"
+
+static std::string drain(BodyWriter& body, std::size_t capacity) {
+    std::string out;
+    std::vector<char> buffer(capacity);
+    while (std::size_t n = body.read(buffer.data(), buffer.size())) out.append(buffer.data(), n);
+    return out;
+}
+
+TEST(TestBody, TestCommandsMatchJsonSerialisation) {
+    CommandsRequest request(CommandEntry("feed", {"a.com", "quote\"d", "back\\slash", "tab\tnew\nline\x01"}, "add"));
+    request.commands.emplace_back("other", std::vector<std::string>{}, "remove");
+
+    CommandsBodyWriter body(request);
+    auto streamed = drain(body, 5);
+
+    ASSERT_EQ(nlohmann::json::parse(streamed), nlohmann::json(request));
+}
+
+TEST(TestBody, TestEmptyRequestAndRewind) {
+    CommandsRequest request;
+    CommandsBodyWriter body(request);
+    ASSERT_EQ(drain(body, 64), R"({"commands":[]})");
+
+    ASSERT_TRUE(body.rewind());
+    ASSERT_EQ(drain(body, 1), R"({"commands":[]})");
+}
+
+TEST(TestBody, TestStringBodyIsServedInSlices) {
+    std::string document = R"({"status":"enable"})";
+    StringBodyWriter body(document);
+    ASSERT_EQ(drain(body, 3), document);
+}
+
+TEST(TestBody, TestGzipStreamsAndRewinds) {
+    std::vector<std::string> entries;
+    for (int i = 0; i < 20000; ++i) entries.push_back("host-" + std::to_string(i) + ".example.com");
+    CommandsRequest request(CommandEntry("feed", entries, "snapshot"));
+    CommandsBodyWriter plain(request);
+    GzipBodyWriter body(plain);
+
+    auto compressed = drain(body, 1000);
+    auto document = Compression::inflate(compressed);
+    ASSERT_EQ(nlohmann::json::parse(document), nlohmann::json(request));
+    ASSERT_LT(compressed.size() * 4, document.size());
+
+    ASSERT_TRUE(body.rewind());
+    ASSERT_EQ(drain(body, 65536), compressed);
+}
@@ -0,0 +1,32 @@
+#include <gtest/gtest.h>
+#include "include/forti_api.hpp"
+
+TEST(TestCache, ReadRacingAWriteIsNotStored) {
+    CmdbCache::enable();
+    Response table;
+    table.status = "success";
+
+    auto generation = CmdbCache::generation();
+    CmdbCache::invalidate("10.0.0.1:443", "/cmdb/firewall/policy/12");  // a write completed while the read was out
+    CmdbCache::store("10.0.0.1:443", "/cmdb/firewall/policy", table, "7", generation);
+    EXPECT_FALSE(CmdbCache::lookup<Response>("10.0.0.1:443", "/cmdb/firewall/policy").value);
+
+    CmdbCache::store("10.0.0.1:443", "/cmdb/firewall/policy", table, "7", CmdbCache::generation());
+    EXPECT_TRUE(CmdbCache::lookup<Response>("10.0.0.1:443", "/cmdb/firewall/policy").fresh);
+    CmdbCache::disable();
+}
+
+TEST(TestCache, FeedPushDropsCachedEntryLists) {
+    CmdbCache::enable();
+    Response entries;
+    entries.status = "success";
+    std::string list = "/cmdb/system/external-resource/entry-list?include_notes=true&vdom=root&mkey=feed";
+
+    CmdbCache::store("10.0.0.1:443", list, entries, "3", CmdbCache::generation());
+    CmdbCache::invalidate("10.0.0.2:443", "/monitor/system/external-resource/dynamic");  // another gateway
+    EXPECT_TRUE(CmdbCache::lookup<Response>("10.0.0.1:443", list).value);
+
+    CmdbCache::invalidate("10.0.0.1:443", "/monitor/system/external-resource/dynamic");
+    EXPECT_FALSE(CmdbCache::lookup<Response>("10.0.0.1:443", list).value);
+    CmdbCache::disable();
+}
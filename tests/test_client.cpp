@@ -0,0 +1,32 @@
+#include <gtest/gtest.h>
+#include "include/forti_api.hpp"
+
+TEST(TestClient, ScopesSelectTheGatewayAndNest) {
+    FortiClient branch({.gateway_ip = "10.1.0.1", .admin_https_port = 8443}), hub({.gateway_ip = "10.0.0.1"}, "hub");
+    ASSERT_EQ(FortiClient::current(), nullptr);
+    EXPECT_EQ(branch.name(), "10.1.0.1:8443");
+
+    branch.run([&] {
+        EXPECT_EQ(FortiAPI::gateway(), "10.1.0.1:8443");
+        hub.run([] { EXPECT_EQ(FortiAPI::gateway(), "10.0.0.1:443"); });
+        EXPECT_EQ(FortiClient::current(), &branch);
+    });
+    EXPECT_EQ(FortiClient::current(), nullptr);
+}
+
+TEST(TestClient, FleetKeepsOrderAndIsolatesFailures) {
+    std::vector<FortiClient> clients;
+    for (int i = 0; i < 10; ++i) clients.emplace_back(ClientConfig{.gateway_ip = std::format("10.0.{}.1", i)});
+
+    auto results = Fleet(clients, 4).run([](const FortiClient& client) {
+        if (client.name() == "10.0.3.1:443") throw std::runtime_error("unreachable");
+        return FortiAPI::gateway();
+    });
+
+    ASSERT_EQ(results.size(), 10);
+    for (int i = 0; i < 10; ++i) {
+        EXPECT_EQ(results[i].client, clients[i].name());
+        if (i == 3) EXPECT_THROW(results[i].get(), std::runtime_error);
+        else EXPECT_EQ(results[i].get(), clients[i].name());
+    }
+}
@@ -0,0 +1,73 @@
+#include <gtest/gtest.h>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <optional>
+#include <string>
+#include <vector>
+#include "include/forti_api.hpp"
+
+TEST(TestConfigReload, ReloadSwapsSnapshotAndKeepsTheOldOneAlive) {
+    FortiClient client({.gateway_ip = "10.2.0.1", .api_key = "old"});
+    auto in_flight = client.config();
+
+    client.reload({.gateway_ip = "10.2.0.2", .api_key = "new"});
+    EXPECT_EQ(client.run([] { return FortiAPI::gateway(); }), "10.2.0.2:443");
+    EXPECT_EQ(client.config()->auth_header, "Authorization: Bearer new");
+    EXPECT_EQ(in_flight->auth_header, "Authorization: Bearer old");
+    EXPECT_EQ(in_flight->base_url, "https://10.2.0.1:443/api/v2");
+}
+
+TEST(TestConfigReload, WatcherPublishesFileChanges) {
+    auto path = std::filesystem::temp_directory_path() / "forti_api_test_config.json";
+    auto write = [&](const nlohmann::json& config) { std::ofstream(path) << config.dump(); };
+    write({{"gateway_ip", "10.3.0.1"}, {"api_key", "first"}});
+
+    FortiClient client({.gateway_ip = "0.0.0.0"});
+    ConfigWatcher watcher(path, client);
+    EXPECT_TRUE(watcher.check());
+    EXPECT_FALSE(watcher.check());
+    EXPECT_EQ(client.config()->gateway, "10.3.0.1:443");
+
+    write({{"gateway_ip", "10.3.0.1"}, {"admin_https_port", 8443}, {"api_key", "second"}});
+    EXPECT_TRUE(watcher.check());
+    EXPECT_EQ(client.config()->gateway, "10.3.0.1:8443");
+    EXPECT_EQ(client.config()->config.api_key, "second");
+
+    std::ofstream(path) << "{ not json";
+    EXPECT_FALSE(watcher.check());
+    EXPECT_EQ(client.config()->config.api_key, "second");
+    std::filesystem::remove(path);
+}
+
+TEST(TestConfigReload, EnvironmentWatcherReportsAMissingVariableOnce) {
+    const char* names[] = {"FORTIGATE_ADMIN_HTTPS_PORT", "FORTIGATE_GATEWAY_IP", "FORTIGATE_API_KEY"};
+    std::vector<std::optional<std::string>> saved;
+    for (auto name : names) {
+        const char* value = std::getenv(name);
+        saved.push_back(value ? std::optional<std::string>(value) : std::nullopt);
+    }
+    setenv("FORTIGATE_ADMIN_HTTPS_PORT", "8443", 1);
+    setenv("FORTIGATE_GATEWAY_IP", "10.4.0.1", 1);
+    unsetenv("FORTIGATE_API_KEY");
+
+    FortiClient client({.gateway_ip = "0.0.0.0"});
+    ConfigWatcher watcher(client);
+    testing::internal::CaptureStderr();
+    EXPECT_FALSE(watcher.check());
+    EXPECT_FALSE(watcher.check());
+    auto logged = testing::internal::GetCapturedStderr();
+    EXPECT_EQ(logged.find("[DEBUG]"), std::string::npos);
+    EXPECT_NE(logged.find("FORTIGATE_API_KEY"), std::string::npos);
+    EXPECT_EQ(logged.find("FORTIGATE_API_KEY"), logged.rfind("FORTIGATE_API_KEY"));
+    EXPECT_EQ(client.config()->gateway, "0.0.0.0:443");
+
+    setenv("FORTIGATE_API_KEY", "from-env", 1);
+    EXPECT_TRUE(watcher.check());
+    EXPECT_EQ(client.config()->gateway, "10.4.0.1:8443");
+
+    for (std::size_t i = 0; i < saved.size(); ++i) {
+        if (saved[i]) setenv(names[i], saved[i]->c_str(), 1);
+        else unsetenv(names[i]);
+    }
+}
@@ -3,7 +3,7 @@
 //
 
 #include <gtest/gtest.h>
-#include "include/forti_api/dns_filter.hpp"
+#include "include/forti_api.hpp"
 
 TEST(TestDNSFilter, TestAddRemove) {
     std::string name = "test-123";
@@ -28,16 +28,9 @@ TEST(TestDNSFilter, TestToggleFilters) {
     filter.monitor(3);
     DNSFilter::update(profile);
 
-    const auto& [match_found, index] = filter.find_category(1);
-    ASSERT_FALSE(match_found);
-
-    const auto& [match_found1, index1] = filter.find_category(2);
-    ASSERT_TRUE(match_found1);
-    ASSERT_TRUE(filter.filters[index1].action == "block");
-
-    const auto& [match_found2, index2] = filter.find_category(3);
-    ASSERT_TRUE(match_found2);
-    ASSERT_TRUE(filter.filters[index2].action == "monitor");
+    ASSERT_FALSE(filter.contains(1));
+    ASSERT_TRUE(filter.action(2) == "block");
+    ASSERT_TRUE(filter.action(3) == "monitor");
 
     DNSFilter::del(profile.name);
     ASSERT_FALSE(DNSFilter::contains(profile.name));
@@ -46,3 +39,101 @@ TEST(TestDNSFilter, TestToggleFilters) {
 TEST(TestDNSFilter, TestContains192) {
     ASSERT_TRUE(DNSFilter::get("advanced").ftgd_dns.contains(193));
 }
+
+TEST(TestDNSFilter, TestBulkCategoryOperations) {
+    DNSFilterOptions a, b;
+    a.block(DNSFilterOptions::categories_of({1, 2, 3}));
+    a.monitor(4);
+    b.monitor(DNSFilterOptions::categories_of({2, 4, 5}));
+    b.block(3);
+
+    auto both = a;
+    both.unite(b);
+    EXPECT_EQ(both.blocked(), DNSFilterOptions::categories_of({1, 2, 3}));
+    EXPECT_EQ(both.monitored(), DNSFilterOptions::categories_of({4, 5}));
+
+    auto common = a;
+    common.intersect(b);
+    EXPECT_EQ(common.blocked(), DNSFilterOptions::categories_of({3}));
+    EXPECT_EQ(common.monitored(), DNSFilterOptions::categories_of({2, 4}));
+    EXPECT_FALSE(common.contains(1));
+
+    a.allow(DNSFilterOptions::categories_of({1, 4}));
+    EXPECT_EQ(a.categories(), DNSFilterOptions::categories_of({2, 3}));
+    EXPECT_THROW(a.block(DNSFilterOptions::category_limit), std::out_of_range);
+}
+
+TEST(TestDNSFilter, TestFiltersRoundTripKeepsIds) {
+    auto wire = nlohmann::json::parse(R"({"options": "error-allow", "filters": [
+        {"id": 7, "q_origin_key": 7, "category": 26, "action": "block", "log": "disable"},
+        {"id": 3, "q_origin_key": 3, "category": 2, "action": "monitor", "log": "enable"}]})");
+    auto options = wire.get<DNSFilterOptions>();
+    EXPECT_EQ(options.action(26), "block");
+    EXPECT_FALSE(options.logged().test(26));
+
+    options.block(5);
+    auto filters = nlohmann::json(options)["filters"];
+    ASSERT_EQ(filters.size(), 3);
+    EXPECT_EQ(filters[0]["category"], 2);
+    EXPECT_EQ(filters[0]["id"], 3);
+    EXPECT_EQ(filters[1]["category"], 5);
+    EXPECT_EQ(filters[1]["id"], 0);
+    EXPECT_EQ(filters[1]["log"], "enable");
+    EXPECT_EQ(filters[2]["id"], 7);
+    EXPECT_EQ(filters[2]["log"], "disable");
+    EXPECT_EQ(nlohmann::json(options).get<DNSFilterOptions>(), options);
+}
+
+TEST(TestDNSFilter, TestUnknownRowsRoundTripVerbatim) {
+    auto wire = nlohmann::json::parse(R"({"options": "", "filters": [
+        {"id": 1, "category": 26, "action": "block", "log": "enable"},
+        {"id": 2, "category": 12, "action": "warning", "log": "enable"},
+        {"id": 3, "category": 300, "action": "block", "log": "disable"}]})");
+    DNSFilterOptions options;
+    ASSERT_NO_THROW(options = wire.get<DNSFilterOptions>());
+    EXPECT_EQ(options.action(26), "block");
+    EXPECT_EQ(nlohmann::json(options)["filters"], wire["filters"]);
+
+    options.block(12);  // an edit to the category replaces its unknown row
+    auto filters = nlohmann::json(options)["filters"];
+    ASSERT_EQ(filters.size(), 3);
+    EXPECT_EQ(filters[0]["category"], 12);
+    EXPECT_EQ(filters[0]["action"], "block");
+    EXPECT_EQ(filters[2]["category"], 300);
+}
+
+TEST(TestDNSFilter, TestPlanOnlyReportsChangedProfiles) {
+    DNSProfile filtered("filtered"), untouched("untouched");
+    filtered.block_category(26);
+    untouched.monitor_category(5);
+
+    DNSFilter::Plan plan({filtered, untouched});
+    plan.allow(26).block(DNSFilterOptions::categories_of({61, 86})).edit([](DNSProfile& profile) {
+        if (profile.name == "untouched") profile.ftgd_dns.block(DNSFilterOptions::Categories());
+    });
+
+    auto changes = plan.changes();
+    ASSERT_EQ(changes.size(), 2);
+    EXPECT_EQ(changes[0].profile, "filtered");
+    EXPECT_EQ(changes[0].unfiltered, DNSFilterOptions::categories_of({26}));
+    EXPECT_EQ(changes[0].blocked, DNSFilterOptions::categories_of({61, 86}));
+    EXPECT_EQ(changes[0].patch.size(), 1);
+    EXPECT_TRUE(changes[0].patch.contains("ftgd-dns"));
+    EXPECT_NE(plan.report().find("filtered: block [61 86] unfiltered [26]"), std::string::npos);
+
+    DNSFilter::Plan noop({untouched});
+    noop.allow(26);
+    EXPECT_TRUE(noop.changes().empty());
+    EXPECT_EQ(noop.report(), "0 of 1 profiles change\n");
+}
+
+TEST(TestDNSFilter, TestPlanApplyLabelsItemsLikeFetch) {
+    // nothing listens on port 1, so every PUT fails fast with a transport error
+    FortiClient branch({.gateway_ip = "127.0.0.1", .admin_https_port = 1});
+    DNSProfile filtered("filtered");
+    filtered.block_category(26);
+
+    auto result = branch.run([&] { return DNSFilter::Plan({filtered}).allow(26).apply(); });
+    EXPECT_TRUE(result.succeeded().empty());
+    EXPECT_EQ(result.failed(), std::vector<std::string>{DNSFilter::object_path("filtered")});
+}
@@ -0,0 +1,71 @@
+#include <gtest/gtest.h>
+#include <atomic>
+#include <chrono>
+#include "include/forti_api.hpp"
+
+static SystemInterface make_interface(std::string name, std::string vdom, std::string type) {
+    SystemInterface interface;
+    interface.name = std::move(name);
+    interface.vdom = std::move(vdom);
+    interface.type = std::move(type);
+    return interface;
+}
+
+TEST(TestInterfaceCache, IndexesByNameVdomAndType) {
+    auto snapshot = InterfaceCache::publish({make_interface("wan1", "root", "physical"),
+                                             make_interface("wan1", "dmz", "physical"),
+                                             make_interface("vpn0", "root", "tunnel")});
+
+    ASSERT_NE(snapshot->find("wan1", "dmz"), nullptr);
+    EXPECT_EQ(snapshot->find("wan1", "dmz")->vdom, "dmz");
+    EXPECT_EQ(snapshot->find("vpn0"), &snapshot->interfaces[2]);
+    EXPECT_EQ(snapshot->find("vpn0", "dmz"), nullptr);
+    EXPECT_EQ(snapshot->of_type("physical").size(), 2);
+    EXPECT_TRUE(snapshot->of_type("aggregate").empty());
+
+    EXPECT_EQ(System::Interface::get_tunnel_interface("vpn0").name, "vpn0");
+    EXPECT_THROW(System::Interface::get_physical_interface("vpn0"), std::runtime_error);
+    InterfaceCache::invalidate();
+}
+
+TEST(TestInterfaceCache, ReadersKeepTheirSnapshotAcrossPublishes) {
+    auto before = InterfaceCache::publish({make_interface("port1", "root", "physical")});
+    auto after = InterfaceCache::publish({make_interface("port2", "root", "physical")});
+
+    EXPECT_NE(before->find("port1"), nullptr);
+    EXPECT_EQ(InterfaceCache::snapshot(), after);
+    EXPECT_EQ(InterfaceCache::snapshot()->find("port1"), nullptr);
+    InterfaceCache::invalidate();
+}
+
+static std::atomic<InterfaceCache::Clock::time_point> fake_now;
+
+static void advance(std::chrono::seconds by) { fake_now = fake_now.load() + by; }
+
+TEST(TestInterfaceCache, FailingRefresherOnlyCoversForAStaleSnapshotSoLong) {
+    // nothing listens on port 1, so every refresh fails fast with a transport error
+    FortiClient branch({.gateway_ip = "127.0.0.1", .admin_https_port = 1});
+    auto ttl = InterfaceCache::ttl();
+    auto attempts = Throttle::retry.max_attempts;
+    InterfaceCache::set_ttl(std::chrono::seconds(20));
+    Throttle::retry.max_attempts = 1;
+    fake_now = InterfaceCache::Clock::now();
+    InterfaceCache::set_clock([] { return fake_now.load(); });
+
+    branch.run([] {
+        auto published = InterfaceCache::publish({make_interface("port1", "root", "physical")});
+        InterfaceCache::start_refresher(std::chrono::seconds(50));
+
+        advance(std::chrono::seconds(40));
+        EXPECT_EQ(InterfaceCache::snapshot(), published);  // stale, but the refresher may still replace it
+
+        advance(std::chrono::seconds(70));
+        EXPECT_THROW(InterfaceCache::snapshot(), std::runtime_error);  // past twice the period: refetched inline
+
+        InterfaceCache::stop_refresher();
+        InterfaceCache::invalidate();
+    });
+    InterfaceCache::set_clock(nullptr);
+    Throttle::retry.max_attempts = attempts;
+    InterfaceCache::set_ttl(ttl);
+}
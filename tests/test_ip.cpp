@@ -0,0 +1,83 @@
+#include <gtest/gtest.h>
+#include "include/forti_api/system.hpp"
+
+TEST(TestIP, ParsesIPv4Spellings) {
+    auto host = IP::parse_v4("192.168.1.10");
+    ASSERT_TRUE(host);
+    EXPECT_EQ(host->prefix, 32);
+    EXPECT_EQ(host->address, 0xC0A8010Au);
+
+    EXPECT_EQ(IP::parse_v4("10.1.2.3/8"), IP::parse_v4("10.0.0.0 255.0.0.0"));
+    EXPECT_EQ(IP::parse_v4("10.0.0.0/8")->to_string(), "10.0.0.0 255.0.0.0");
+
+    for (auto bad : {"", "1.2.3", "1.2.3.4.5", "256.1.1.1", "01.2.3.4", "1.2.3.4/33", "1.2.3.4 255.0.255.0", "1.2.3.a"})
+        EXPECT_FALSE(IP::parse_v4(bad)) << bad;
+}
+
+TEST(TestIP, ParsesIPv6Spellings) {
+    auto expanded = IP::parse_v6("2001:0db8:0000:0000:0000:0000:0000:0001");
+    ASSERT_TRUE(expanded);
+    EXPECT_EQ(expanded, IP::parse_v6("2001:db8::1"));
+    EXPECT_EQ(expanded->to_string(), "2001:db8::1/128");
+
+    EXPECT_EQ(IP::parse_v6("::")->to_string(), "::/128");
+    EXPECT_EQ(IP::parse_v6("fe80::/10")->to_string(), "fe80::/10");
+    EXPECT_EQ(IP::parse_v6("::ffff:192.0.2.1")->to_string(), "::ffff:c000:201/128");
+    EXPECT_EQ(IP::parse_v6("1:0:0:2:0:0:0:3")->to_string(), "1:0:0:2::3/128");
+
+    for (auto bad : {":", ":::", "1::2::3", "1:2:3:4:5:6:7", "1:2:3:4:5:6:7:8:9", "12345::", "1:", "g::", "::/129",
+                     "1:2:3:4:5:6:7::8:9"})
+        EXPECT_FALSE(IP::parse_v6(bad)) << bad;
+}
+
+TEST(TestIP, ContainmentNeverCrossesFamilies) {
+    auto wide = *IP::parse("10.0.0.0/8"), host = *IP::parse("10.20.30.40"), v6 = *IP::parse("::a14:1e28");
+    EXPECT_TRUE(IP::contains(wide, host));
+    EXPECT_FALSE(IP::contains(host, wide));
+    EXPECT_FALSE(IP::contains(wide, v6));
+    EXPECT_TRUE(IP::contains(*IP::parse("2001:db8::/32"), *IP::parse("2001:db8:ffff::1/64")));
+}
+
+TEST(TestIP, TrustHostIsContainmentAware) {
+    APIUser user = nlohmann::json{{"name", "automation"},
+                                  {"trusthost", {{{"id", 1}, {"type", "ipv4-trusthost"}, {"ipv4-trusthost", "10.0.0.0 255.0.0.0"}},
+                                                 {{"id", 2}, {"type", "ipv6-trusthost"}, {"ipv6-trusthost", "2001:db8::/32"}}}}};
+    EXPECT_TRUE(user.is_trusted("10.1.2.3"));
+    EXPECT_TRUE(user.is_trusted("2001:db8::42"));
+    EXPECT_FALSE(user.is_trusted("192.168.0.1"));
+    EXPECT_FALSE(user.is_trusted("not an ip"));
+
+    user.trust("10.9.0.0/16");  // already covered
+    user.trust("192.168.0.0/24");
+    ASSERT_EQ(user.trusthost.size(), 3);
+    EXPECT_EQ(user.trusthost.back().id, 3);
+
+    user.distrust("192.168.0.0 255.255.255.0");
+    EXPECT_EQ(user.trusthost.size(), 2);
+    EXPECT_THROW(user.trust("10.0.0.256"), std::invalid_argument);
+
+    auto wire = nlohmann::json(user)["trusthost"];
+    EXPECT_EQ(wire[0]["ipv4-trusthost"], "10.0.0.0 255.0.0.0");
+    EXPECT_EQ(wire[1]["ipv6-trusthost"], "2001:db8::/32");
+}
+
+TEST(TestIP, TrustHostIndexFollowsTrustAndDistrust) {
+    APIUser user;
+    for (unsigned int i = 0; i < 256; ++i) user.trust(std::format("172.16.{}.0/24", i));
+    user.trust("2001:db8:1::/48");
+    ASSERT_EQ(user.trusthost.size(), 257);
+    EXPECT_EQ(user.trusthost.next_id(), 258);
+
+    auto covering = user.trusthost.covering(*IP::parse("172.16.200.7"));
+    ASSERT_NE(covering, nullptr);
+    EXPECT_EQ(covering->get_subnet(), "172.16.200.0 255.255.255.0");
+    EXPECT_TRUE(user.is_trusted("2001:db8:1:2::/64"));
+    EXPECT_FALSE(user.is_trusted("172.16.0.0/16"));
+
+    user.distrust("172.16.200.0/24");
+    EXPECT_FALSE(user.is_trusted("172.16.200.7"));
+    EXPECT_TRUE(user.is_trusted("172.16.201.7"));
+    user.trust("172.16.0.0/16");
+    EXPECT_TRUE(user.is_trusted("172.16.200.7"));
+    EXPECT_EQ(user.trusthost.back().id, 258);  // ids are never reused
+}
@@ -0,0 +1,51 @@
+#include <gtest/gtest.h>
+#include "include/forti_api/metrics.hpp"
+
+TEST(TestMetrics, TestNormalizeCollapsesObjectKeys) {
+    ASSERT_EQ(Metrics::normalize("/cmdb/firewall/policy/12?vdom=root"), "/cmdb/firewall/policy/{mkey}");
+    ASSERT_EQ(Metrics::normalize("/cmdb/firewall/policy?filter=name==x"), "/cmdb/firewall/policy");
+    ASSERT_EQ(Metrics::normalize("/cmdb/system/api-user/admin/trusthost"), "/cmdb/system/api-user/{mkey}");
+    ASSERT_EQ(Metrics::normalize("/monitor/system/available-interfaces?mkey=wan1"),
+              "/monitor/system/available-interfaces");
+    ASSERT_EQ(Metrics::normalize("/monitor/system/external-resource/dynamic"),
+              "/monitor/system/external-resource/dynamic");
+    ASSERT_EQ(Metrics::normalize("/monitor/system/external-resource/dynamic/feed-a"),
+              "/monitor/system/external-resource/dynamic/{mkey}");
+}
+
+TEST(TestMetrics, TestHistogramQuantiles) {
+    Metrics::Histogram histogram;
+    for (int i = 0; i < 98; ++i) histogram.observe(800);   // 0.8 ms
+    for (int i = 0; i < 2; ++i) histogram.observe(300000);  // 300 ms
+
+    ASSERT_EQ(histogram.count.load(), 100);
+    ASSERT_DOUBLE_EQ(histogram.quantile(0.50), 0.001);
+    ASSERT_DOUBLE_EQ(histogram.quantile(0.99), 0.5);
+}
+
+TEST(TestMetrics, TestExportersIncludeRecordedSeries) {
+    CURL* handle = curl_easy_init();
+    auto* series = Metrics::record(handle, "GET", "/cmdb/dnsfilter/profile/default", CURLE_OK);
+    Metrics::record_decode(series, std::chrono::milliseconds(3));
+    Metrics::record(handle, "GET", "/cmdb/dnsfilter/profile/other", CURLE_COULDNT_CONNECT);
+    curl_easy_cleanup(handle);
+
+    auto text = Metrics::prometheus();
+    ASSERT_NE(text.find(R"(forti_api_requests_total{endpoint="/cmdb/dnsfilter/profile/{mkey}",method="GET"} 2)"),
+              std::string::npos);
+    ASSERT_NE(text.find(R"(forti_api_errors_total{endpoint="/cmdb/dnsfilter/profile/{mkey}",method="GET"} 1)"),
+              std::string::npos);
+
+    auto profile = [] {
+        auto json = Metrics::json();
+        auto it = std::find_if(json.begin(), json.end(), [](const auto& s) {
+            return s["endpoint"] == "/cmdb/dnsfilter/profile/{mkey}" && s["method"] == "GET";
+        });
+        return it == json.end() ? nlohmann::json() : *it;
+    };
+    ASSERT_FALSE(profile().is_null());
+    ASSERT_EQ(profile()["phases"]["decode"]["count"], 1);
+
+    Metrics::reset();
+    ASSERT_EQ(profile()["requests"], 0);
+}
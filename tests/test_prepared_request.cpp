@@ -0,0 +1,16 @@
+#include <gtest/gtest.h>
+#include "include/forti_api.hpp"
+
+TEST(TestPreparedRequest, BindsToTheActiveClientAndFollowsReloads) {
+    // nothing listens on port 1, so every send fails fast with a transport error
+    FortiClient branch({.gateway_ip = "127.0.0.1", .admin_https_port = 1});
+    auto request = branch.run([] { return PreparedRequest("POST", "/monitor/system/external-resource/dynamic"); });
+    EXPECT_EQ(request.url(), "https://127.0.0.1:1/api/v2/monitor/system/external-resource/dynamic");
+
+    EXPECT_THROW(request.send(R"({"commands":[]})"), std::runtime_error);
+    EXPECT_TRUE(request.response().empty());
+
+    branch.reload({.gateway_ip = "127.0.0.2", .admin_https_port = 1});
+    EXPECT_THROW(request.execute(), std::runtime_error);
+    EXPECT_EQ(request.url(), "https://127.0.0.2:1/api/v2/monitor/system/external-resource/dynamic");
+}
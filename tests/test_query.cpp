@@ -0,0 +1,40 @@
+#include <gtest/gtest.h>
+#include "include/forti_api/firewall.hpp"
+#include "include/forti_api/system.hpp"
+#include "include/forti_api/threat_feed.hpp"
+
+TEST(TestQuery, TestWireKeysAndOperators) {
+    auto query = Query<FirewallPolicy>()
+            .eq(&FirewallPolicy::name, "wan in")
+            .ne(&FirewallPolicy::ssl_ssh_profile, "no-inspection")
+            .ge(&FirewallPolicy::policyid, 10);
+
+    ASSERT_EQ(query.str(), "filter=name==wan%20in&filter=ssl-ssh-profile!=no-inspection&filter=policyid>=10");
+    ASSERT_EQ(query.apply("/cmdb/firewall/policy?vdom=root"),
+              "/cmdb/firewall/policy?vdom=root&" + query.str());
+}
+
+TEST(TestQuery, TestAnyOfIsSingleFilter) {
+    auto query = Query<PushThreatFeed>().any_of(&PushThreatFeed::category, std::vector<unsigned int>{192, 193});
+    ASSERT_EQ(query.str(), "filter=category==192,category==193");
+}
+
+TEST(TestQuery, TestEmptyQueryLeavesPathAlone) {
+    ASSERT_EQ(Query<FirewallPolicy>().apply("/cmdb/firewall/policy"), "/cmdb/firewall/policy");
+}
+
+TEST(TestQuery, TestProjectionUsesWireKeys) {
+    using Names = Projection<FirewallPolicy, &FirewallPolicy::policyid, &FirewallPolicy::ssl_ssh_profile>;
+    ASSERT_EQ(Names::str(), "format=policyid|ssl-ssh-profile");
+
+    auto query = Query<FirewallPolicy>().eq(&FirewallPolicy::status, "enable");
+    ASSERT_EQ(Names::apply(query.apply("/cmdb/firewall/policy")),
+              "/cmdb/firewall/policy?filter=status==enable&format=policyid|ssl-ssh-profile");
+}
+
+TEST(TestQuery, TestMonitorProjectionUsesMemberNames) {
+    using Addresses = Projection<SystemInterface, &SystemInterface::name, &SystemInterface::ipv4_addresses>;
+    ASSERT_EQ(Addresses::str(), "format=name|ipv4-addresses");
+    ASSERT_EQ(Addresses::apply("/monitor/system/available-interfaces?vdom=root"),
+              "/monitor/system/available-interfaces?vdom=root&format=name|ipv4_addresses");
+}
@@ -0,0 +1,66 @@
+#include <gtest/gtest.h>
+#include "include/forti_api/stream.hpp"
+#include "include/forti_api/types/lazy_response.h"
+#include "include/forti_api/types/threat_feed/ext_connector.h"
+
+static std::vector<std::string> split(const std::string& body, const std::vector<std::string>& target,
+                                      std::string& envelope, std::size_t chunk = 7) {
+    std::vector<std::string> elements;
+    JsonArrayStream stream(target, [&](std::string_view element) { elements.emplace_back(element); });
+    for (std::size_t i = 0; i < body.size(); i += chunk) stream.feed(std::string_view(body).substr(i, chunk));
+    envelope = stream.remainder();
+    return elements;
+}
+
+TEST(TestStream, TestSplitsResultsAcrossChunks) {
+    std::string body = R"({"http_status":200,"results":[{"name":"a,]"},{"name":"b","x":[1,{"y":2}]}, {"name":"c\"}"}],"status":"success"})";
+    std::string envelope;
+    auto elements = split(body, {"results"}, envelope);
+
+    ASSERT_EQ(elements.size(), 3);
+    ASSERT_EQ(nlohmann::json::parse(elements[0])["name"], "a,]");
+    ASSERT_EQ(nlohmann::json::parse(elements[1])["x"][1]["y"], 2);
+    ASSERT_EQ(nlohmann::json::parse(elements[2])["name"], "c\"}");
+
+    auto response = nlohmann::json::parse(envelope).get<Response>();
+    ASSERT_EQ(response.http_status, 200);
+    ASSERT_EQ(response.status, "success");
+}
+
+TEST(TestStream, TestNestedTargetDecodesEntries) {
+    std::string body = R"({"results":{"status":"ok","entries":[{"entry":"a.com","valid":"true"},{"entry":"b.com","valid":"false"}]},"results2":[1]})";
+    std::vector<Entry> entries;
+    JsonArrayStream stream({"results", "entries"}, StreamDecoder<Entry, std::function<void(Entry)>>{
+            [&](Entry entry) { entries.push_back(std::move(entry)); }});
+    stream.feed(body);
+
+    ASSERT_EQ(entries.size(), 2);
+    ASSERT_EQ(entries[1].entry, "b.com");
+    ASSERT_EQ(nlohmann::json::parse(stream.remainder())["results"]["entries"].size(), 0);
+}
+
+TEST(TestStream, TestElementLimit) {
+    JsonArrayStream stream({"results"}, [](std::string_view) {}, 16);
+    ASSERT_THROW(stream.feed(R"({"results":[{"name":"much-longer-than-sixteen-bytes"}]})"), std::length_error);
+}
+
+TEST(TestStream, TestLazyResponseDefersResults) {
+    std::string body = R"({"http_status":200,"results":[{"entry":"a.com","valid":"true"},{"entry":"b]","valid":"false"}],"matched_count":2})";
+    auto split = JsonArrayStream::split(body);
+    ASSERT_EQ(body.substr(split.begin, split.end - split.begin).front(), '[');
+    ASSERT_EQ(nlohmann::json::parse(split.envelope)["results"], nlohmann::json::array());
+
+    auto response = LazyResponse<Entry>::from_body(body);
+    ASSERT_TRUE(response);
+    ASSERT_EQ(response->http_status, 200);
+    ASSERT_EQ(response->matched_count, 2);
+    auto results = response->results();
+    ASSERT_EQ(results.size(), 2);
+    ASSERT_EQ(results[1].entry, "b]");
+
+    auto missing = LazyResponse<Entry>::from_body(R"({"http_status":404,"status":"error"})");
+    ASSERT_TRUE(missing);
+    ASSERT_EQ(missing->http_status, 404);
+    ASSERT_TRUE(missing->results().empty());
+    ASSERT_FALSE(LazyResponse<Entry>::from_body("<html>"));
+}
@@ -3,7 +3,7 @@
 //
 
 #include <gtest/gtest.h>
-#include "include/forti_api/threat_feed.hpp"
+#include "include/forti_api.hpp"
 
 TEST(TestThreatFeed, TestGetAllFeeds) {
     auto feeds = ThreatFeed::get();
@@ -23,3 +23,24 @@ TEST(TestThreatFeed, TestAddAndRemoveThreatFeed) {
     ThreatFeed::del(name);
     ASSERT_TRUE(!ThreatFeed::contains(name));
 }
+
+TEST(TestThreatFeed, TestFailedPushForgetsTheFeed) {
+    // nothing listens on port 1, so every push fails fast with a transport error
+    FortiClient branch({.gateway_ip = "127.0.0.1", .admin_https_port = 1});
+    FortiClient other({.gateway_ip = "127.0.0.2", .admin_https_port = 1});
+    std::string name = "offline-feed";
+
+    branch.run([&] {
+        FeedSync::seed(name, {"a.com", "b.com"});
+        ASSERT_FALSE(FeedSync::plan(name, {"a.com", "c.com"}).snapshot);
+    });
+    EXPECT_TRUE(other.run([&] { return FeedSync::plan(name, {"a.com", "c.com"}).snapshot; }));  // separate baseline
+
+    branch.run([&] {
+        EXPECT_THROW(FeedSync::sync(name, {"a.com", "c.com"}), std::runtime_error);
+        auto next = FeedSync::plan(name, {"a.com", "c.com"});
+        EXPECT_TRUE(next.snapshot);
+        EXPECT_EQ(next.added.size(), 2);
+        FeedSync::forget(name);
+    });
+}
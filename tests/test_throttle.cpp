@@ -0,0 +1,52 @@
+#include <gtest/gtest.h>
+#include <future>
+#include "include/forti_api/throttle.hpp"
+
+TEST(TestThrottle, TestClassify) {
+    ASSERT_EQ(Throttle::classify("GET", "/cmdb/firewall/policy"), Throttle::EndpointClass::CmdbRead);
+    ASSERT_EQ(Throttle::classify("PUT", "/cmdb/firewall/policy/3"), Throttle::EndpointClass::CmdbWrite);
+    ASSERT_EQ(Throttle::classify("POST", "/monitor/system/external-resource/dynamic"), Throttle::EndpointClass::Monitor);
+}
+
+TEST(TestThrottle, TestCongestionAndBackoff) {
+    ASSERT_TRUE(Throttle::congested(CURLE_OK, 429));
+    ASSERT_TRUE(Throttle::congested(CURLE_OK, 503));
+    ASSERT_TRUE(Throttle::congested(CURLE_OPERATION_TIMEDOUT, 0));
+    ASSERT_FALSE(Throttle::congested(CURLE_OK, 404));
+    ASSERT_FALSE(Throttle::congested(CURLE_SSL_CACERT_BADFILE, 0));
+
+    for (unsigned int attempt = 1; attempt < 8; ++attempt)
+        ASSERT_LE(Throttle::backoff(attempt), Throttle::retry.cap);
+    ASSERT_GE(Throttle::backoff(1, 2), std::chrono::seconds(2));
+}
+
+TEST(TestThrottle, TestConcurrencyLimitBlocksUntilReleased) {
+    auto original = Throttle::limits(Throttle::EndpointClass::Monitor);
+    auto limits = original;
+    limits.min_concurrency = limits.max_concurrency = 1;
+    Throttle::configure(Throttle::EndpointClass::Monitor, limits);
+
+    auto held = Throttle::acquire(Throttle::EndpointClass::Monitor);
+    auto waiting = std::async(std::launch::async, [] { return Throttle::acquire(Throttle::EndpointClass::Monitor); });
+    ASSERT_EQ(waiting.wait_for(std::chrono::milliseconds(50)), std::future_status::timeout);
+
+    held.release();
+    ASSERT_EQ(waiting.wait_for(std::chrono::seconds(2)), std::future_status::ready);
+    waiting.get().release();
+
+    Throttle::configure(Throttle::EndpointClass::Monitor, original);
+}
+
+TEST(TestThrottle, TestTokenBucketPacesRequests) {
+    auto original = Throttle::limits(Throttle::EndpointClass::CmdbWrite);
+    auto limits = original;
+    limits.rate = 50;
+    limits.burst = 1;
+    Throttle::configure(Throttle::EndpointClass::CmdbWrite, limits);
+
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < 6; ++i) Throttle::acquire(Throttle::EndpointClass::CmdbWrite);
+    ASSERT_GE(std::chrono::steady_clock::now() - start, std::chrono::milliseconds(90));
+
+    Throttle::configure(Throttle::EndpointClass::CmdbWrite, original);
+}
@@ -0,0 +1,79 @@
+#include <gtest/gtest.h>
+#include "include/forti_api.hpp"
+
+TEST(TestWireDiff, OnlyChangedAttributesAreKept) {
+    FirewallService before("web"), after("web");
+    before.tcp_portrange = "80";
+    after.tcp_portrange = "8080";
+    after.comment = "moved";
+
+    auto patch = Wire::diff(before, after);
+    EXPECT_EQ(patch, (nlohmann::json{{"tcp-portrange", "8080"}, {"comment", "moved"}}));
+    EXPECT_TRUE(Wire::diff(before, before).empty());
+}
+
+TEST(TestWireDiff, TablesAreSentWhole) {
+    Address all, lan;
+    all.name = "all";
+    lan.name = "lan";
+
+    FirewallPolicy before, after;
+    before.srcaddr = {all};
+    after.srcaddr = {all, lan};
+
+    auto patch = Wire::diff(before, after);
+    ASSERT_EQ(patch.size(), 1);
+    EXPECT_EQ(patch["srcaddr"].size(), 2);
+}
+
+TEST(TestWireDiff, RawPayloadsAreHyphenated) {
+    nlohmann::json raw = {{"update_method", "push"}, {"q_origin_key", "feed"},
+                          {"entries", {{{"entry_type", "domain"}}, "a_b.example"}}};
+    EXPECT_EQ(Wire::hyphenate(raw), (nlohmann::json{{"update-method", "push"},
+                                                     {"entries", {{{"entry-type", "domain"}}, "a_b.example"}}}));
+}
+
+TEST(TestWireDiff, ModifyCollectsChangesWithoutSending) {
+    FirewallSchedule schedule;
+    schedule.name = "nightly";
+    schedule.modify();
+    EXPECT_TRUE(schedule.editing());
+
+    schedule.set_time("22:00", "06:00");
+    schedule.set_color(Color::RED);
+    EXPECT_EQ(schedule.changes(), (nlohmann::json{{"start", "22:00"}, {"end", "06:00"}, {"color", Color::RED}}));
+
+    auto copy = schedule;  // a copy carries its own batch
+    copy.discard();
+    EXPECT_TRUE(schedule.editing());
+
+    schedule.discard();
+    EXPECT_FALSE(schedule.editing());
+    EXPECT_TRUE(schedule.changes().empty());
+    static_assert(sizeof(Editable<FirewallSchedule>) == sizeof(void*), "read-only objects carry no snapshot");
+}
+
+TEST(TestWireDiff, UnchangedPolicyUpdateSucceedsWithoutARequest) {
+    FirewallPolicy policy;
+    policy.policyid = 7;
+    auto response = FortiGate::Policies::update_async(policy, policy).get();
+    EXPECT_EQ(response.status, "success");
+    EXPECT_EQ(response.http_status, 200);
+}
+
+TEST(TestWireDiff, FailedCommitKeepsTheBatchOpen) {
+    // nothing listens on port 1, so every PUT fails fast with a transport error
+    FortiClient branch({.gateway_ip = "127.0.0.1", .admin_https_port = 1});
+    FirewallSchedule schedule;
+    schedule.name = "nightly";
+    schedule.modify();
+    schedule.set_time("22:00", "06:00");
+
+    EXPECT_THROW(branch.run([&] { return schedule.commit(); }), std::runtime_error);
+    EXPECT_TRUE(schedule.editing());
+    EXPECT_EQ(schedule.changes(), (nlohmann::json{{"start", "22:00"}, {"end", "06:00"}}));
+
+    schedule.discard();
+    EXPECT_THROW(branch.run([&] { schedule.set_color(Color::RED); }), std::runtime_error);
+    EXPECT_FALSE(schedule.editing());  // a failed write-through does not leave a batch behind
+}